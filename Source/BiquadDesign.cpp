@@ -0,0 +1,582 @@
+/*
+  ==============================================================================
+
+    BiquadDesign.cpp
+    Created: 16 Oct 2026 2:40:18pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#include "BiquadDesign.h"
+#include <complex>
+#include <limits>
+
+//==============================================================================
+
+namespace
+{
+    using MathConstants = juce::MathConstants<double>;
+
+    // Keep the design inside the valid range, the bilinear transform blows up at Nyquist.
+    double limitFrequency(double frequency, double sampleRate)
+    {
+        return juce::jlimit(1.0, sampleRate * 0.499, frequency);
+    }
+
+    BiquadCoefficients normalise(double b0, double b1, double b2, double a0, double a1, double a2)
+    {
+        auto a0inv = 1.0 / a0;
+
+        BiquadCoefficients c;
+        c.b0 = b0 * a0inv;
+        c.b1 = b1 * a0inv;
+        c.b2 = b2 * a0inv;
+        c.a1 = a1 * a0inv;
+        c.a2 = a2 * a0inv;
+
+        return c;
+    }
+
+    // Butterworth section Qs for an even order (2, 4, 6, 8), same as FilterDesign::designIIR*HighOrderButterworthMethod.
+    const std::array<double, MaxCutSections>& getButterworthQs(int numSections)
+    {
+        static const auto table = []
+        {
+            std::array<std::array<double, MaxCutSections>, MaxCutSections> qs {};
+
+            for (int s = 0; s < MaxCutSections; ++s)
+            {
+                auto order = 2 * (s + 1);
+
+                for (int i = 0; i <= s; ++i)
+                    qs[s][i] = 1.0 / (2.0 * std::cos((2.0 * i + 1.0) * MathConstants::pi / (order * 2.0)));
+            }
+
+            return qs;
+        }();
+
+        return table[juce::jlimit(1, MaxCutSections, numSections) - 1];
+    }
+
+    // n = tan(pi * f / fs) is shared by every section of a cascade, so it's only computed once per design.
+    BiquadCoefficients makeHighPassSection(double n, double Q)
+    {
+        auto nSquared = n * n;
+        auto invQ = 1.0 / Q;
+        auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        return normalise(c1, c1 * -2.0, c1,
+                         1.0, c1 * 2.0 * (nSquared - 1.0), c1 * (1.0 - invQ * n + nSquared));
+    }
+
+    // Here n = 1 / tan(pi * f / fs)
+    BiquadCoefficients makeLowPassSection(double n, double Q)
+    {
+        auto nSquared = n * n;
+        auto invQ = 1.0 / Q;
+        auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+        return normalise(c1, c1 * 2.0, c1,
+                         1.0, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - invQ * n + nSquared));
+    }
+
+    // Bell matched to the analog prototype's magnitude (M. Vicanek, "Matched Second Order
+    // Digital Filters", 2016). Same prototype as the RBJ bell, with A = sqrt(gain):
+    //
+    //     H(s) = (s^2 + s A/Q + 1) / (s^2 + s / (A Q) + 1)
+    //
+    // The poles come from impulse invariance, the zeros are solved so |H| is exact at DC,
+    // at the centre frequency and at Nyquist. No frequency warping, so the bell keeps its
+    // shape right up to Nyquist. A handful of exp/cos per design, fine for control rate.
+    BiquadCoefficients makeMatchedPeakSection(double frequency, double Q, double gainFactor, double sampleRate)
+    {
+        auto A = std::sqrt(gainFactor);
+        auto w0 = MathConstants::twoPi * frequency / sampleRate;
+
+        // Poles: exp(s T) of the analog ones, overdamped (real) poles for very wide cuts.
+        auto zeta = 1.0 / (2.0 * A * Q);
+        auto decay = std::exp(-zeta * w0);
+
+        BiquadCoefficients c;
+        c.a2 = decay * decay;
+        c.a1 = zeta <= 1.0 ? -2.0 * decay * std::cos(w0 * std::sqrt(1.0 - zeta * zeta))
+                           : -2.0 * decay * std::cosh(w0 * std::sqrt(zeta * zeta - 1.0));
+
+        // |A(e^jw)|^2 = A0 phi0 + A1 phi1 + A2 phi2, same form for the numerator with B0..B2.
+        auto A0 = (1.0 + c.a1 + c.a2) * (1.0 + c.a1 + c.a2);
+        auto A1 = (1.0 - c.a1 + c.a2) * (1.0 - c.a1 + c.a2);
+        auto A2 = -4.0 * c.a2;
+
+        auto sinSquared = std::sin(w0 * 0.5) * std::sin(w0 * 0.5);
+        auto phi0 = 1.0 - sinSquared;
+        auto phi1 = sinSquared;
+        auto phi2 = 4.0 * phi0 * phi1;
+
+        // Analog |H|^2 at Nyquist (normalised to the centre frequency).
+        auto nyquist = MathConstants::pi / w0;
+        auto nyquistSquared = nyquist * nyquist;
+        auto real = (1.0 - nyquistSquared) * (1.0 - nyquistSquared);
+        auto nyquistGain = (real + nyquistSquared * A * A / (Q * Q))
+                         / (real + nyquistSquared / (A * A * Q * Q));
+
+        auto B0 = A0;                   // unity at DC
+        auto B1 = A1 * nyquistGain;     // analog gain at Nyquist
+        auto B2 = (gainFactor * gainFactor * (A0 * phi0 + A1 * phi1 + A2 * phi2)
+                   - B0 * phi0 - B1 * phi1) / phi2; // full gain at the centre
+
+        auto sqrtB0 = std::sqrt(B0);
+        auto sqrtB1 = std::sqrt(B1);
+        auto W = 0.5 * (sqrtB0 + sqrtB1);
+
+        c.b0 = 0.5 * (W + std::sqrt(juce::jmax(0.0, W * W + B2)));
+        c.b1 = 0.5 * (sqrtB0 - sqrtB1);
+        c.b2 = -B2 / (4.0 * c.b0);
+
+        return c;
+    }
+
+    BiquadCoefficients makeBellSection(float frequencyInHz, float quality, float gainInDecibels,
+                                       PeakDesign design, double sampleRate)
+    {
+        auto gainFactor = juce::Decibels::decibelsToGain((double)gainInDecibels);
+        auto frequency = limitFrequency(juce::jmax(2.0, (double)frequencyInHz), sampleRate);
+        auto Q = (double)quality;
+
+        if (design == PeakDesign::PeakDesign_Matched)
+            return makeMatchedPeakSection(frequency, Q, gainFactor, sampleRate);
+
+        auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+        auto omega = (MathConstants::twoPi * frequency) / sampleRate;
+        auto alpha = std::sin(omega) / (Q * 2.0);
+        auto c2 = -2.0 * std::cos(omega);
+        auto alphaTimesA = alpha * A;
+        auto alphaOverA = alpha / A;
+
+        return normalise(1.0 + alphaTimesA, c2, 1.0 - alphaTimesA,
+                         1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+    }
+
+    // RBJ shelves, same formulas as IIR::Coefficients::makeLowShelf / makeHighShelf.
+    BiquadCoefficients makeShelfSection(bool highShelf, double frequency, double Q, double gainFactor, double sampleRate)
+    {
+        auto A = juce::jmax(0.0, std::sqrt(gainFactor));
+        auto aminus1 = A - 1.0;
+        auto aplus1 = A + 1.0;
+        auto omega = (MathConstants::twoPi * frequency) / sampleRate;
+        auto coso = std::cos(omega);
+        auto beta = std::sin(omega) * std::sqrt(A) / Q;
+
+        // The high shelf is the low one with the sign of cos(w) (and of the odd terms) flipped.
+        auto sign = highShelf ? -1.0 : 1.0;
+        auto aminus1TimesCoso = aminus1 * coso * sign;
+
+        return normalise(A * (aplus1 - aminus1TimesCoso + beta),
+                         A * sign * 2.0 * (aminus1 - aplus1 * coso * sign),
+                         A * (aplus1 - aminus1TimesCoso - beta),
+                         aplus1 + aminus1TimesCoso + beta,
+                         sign * -2.0 * (aminus1 + aplus1 * coso * sign),
+                         aplus1 + aminus1TimesCoso - beta);
+    }
+
+    // RBJ notch, IIR::Coefficients::makeNotchFilter.
+    BiquadCoefficients makeNotchSection(double frequency, double Q, double sampleRate)
+    {
+        auto n = 1.0 / std::tan(MathConstants::pi * frequency / sampleRate);
+        auto nSquared = n * n;
+        auto invQ = 1.0 / Q;
+        auto c1 = 1.0 / (1.0 + n * invQ + nSquared);
+        auto b0 = c1 * (1.0 + nSquared);
+        auto b1 = 2.0 * c1 * (1.0 - nSquared);
+
+        return normalise(b0, b1, b0, 1.0, b1, c1 * (1.0 - n * invQ + nSquared));
+    }
+}
+
+//==============================================================================
+
+double BiquadCoefficients::getMagnitudeForFrequency(double frequency, double sampleRate) const
+{
+    // |H(e^jw)| with z^-1 = e^-jw
+    auto w = MathConstants::twoPi * frequency / sampleRate;
+
+    std::complex<double> z1 = std::polar(1.0, -w);
+    std::complex<double> z2 = z1 * z1;
+
+    auto numerator = b0 + b1 * z1 + b2 * z2;
+    auto denominator = 1.0 + a1 * z1 + a2 * z2;
+
+    return std::abs(numerator / denominator);
+}
+
+bool BiquadCoefficients::hasPolesNearDC() const
+{
+    // 1 + a1 + a2 = |1 - p|^2, about (2 pi f / fs)^2 for a section tuned to f.
+    constexpr auto limit = MathConstants::twoPi / 500.0;
+
+    return 1.0 + a1 + a2 < limit * limit;
+}
+
+double BiquadCoefficients::getPoleRadius() const
+{
+    auto discriminant = a1 * a1 - 4.0 * a2;
+
+    // Complex pair: |p|^2 = a2.
+    if (discriminant < 0.0)
+        return std::sqrt(a2);
+
+    // Two real poles, the one furthest out rings longest.
+    auto root = std::sqrt(discriminant);
+
+    return juce::jmax(std::abs(-a1 + root), std::abs(-a1 - root)) * 0.5;
+}
+
+double ParallelCutCoefficients::getMagnitudeForFrequency(double frequency, double sampleRate) const
+{
+    auto w = MathConstants::twoPi * frequency / sampleRate;
+
+    std::complex<double> z1 = std::polar(1.0, -w);
+    std::complex<double> z2 = z1 * z1;
+
+    std::complex<double> response = direct;
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        const auto& section = sections[i];
+        response += (section.b0 + section.b1 * z1) / (1.0 + section.a1 * z1 + section.a2 * z2);
+    }
+
+    return std::abs(response);
+}
+
+double CutCoefficients::getMagnitudeForFrequency(double frequency, double sampleRate) const
+{
+    auto magnitude = 1.0;
+
+    for (int i = 0; i < numSections; ++i)
+        magnitude *= sections[i].getMagnitudeForFrequency(frequency, sampleRate);
+
+    return magnitude;
+}
+
+double UserBandCoefficients::getMagnitudeForFrequency(double frequency, double sampleRate) const
+{
+    auto magnitude = 1.0;
+
+    for (int i = 0; i < numSections; ++i)
+        magnitude *= sections[i].getMagnitudeForFrequency(frequency, sampleRate);
+
+    return magnitude;
+}
+
+int getNumCutSections(Slope slope)
+{
+    return static_cast<int>(slope) + 1;
+}
+
+CutCoefficients makeLowCutFilter(float frequencyInHz, Slope slope, double sampleRate)
+{
+    CutCoefficients cut;
+    cut.numSections = getNumCutSections(slope);
+
+    auto frequency = limitFrequency(frequencyInHz, sampleRate);
+    auto n = std::tan(MathConstants::pi * frequency / sampleRate);
+    const auto& qs = getButterworthQs(cut.numSections);
+
+    for (int i = 0; i < cut.numSections; ++i)
+        cut.sections[i] = makeHighPassSection(n, qs[i]);
+
+    return cut;
+}
+
+CutCoefficients makeHighCutFilter(float frequencyInHz, Slope slope, double sampleRate)
+{
+    CutCoefficients cut;
+    cut.numSections = getNumCutSections(slope);
+
+    auto frequency = limitFrequency(frequencyInHz, sampleRate);
+    auto n = 1.0 / std::tan(MathConstants::pi * frequency / sampleRate);
+    const auto& qs = getButterworthQs(cut.numSections);
+
+    for (int i = 0; i < cut.numSections; ++i)
+        cut.sections[i] = makeLowPassSection(n, qs[i]);
+
+    return cut;
+}
+
+BiquadCoefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return makeBellSection(chainSettings.peakFreq, chainSettings.peakQuality, chainSettings.peakGainInDecibels,
+                           chainSettings.peakDesign, sampleRate);
+}
+
+CutCoefficients makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return makeLowCutFilter(chainSettings.lowCutFreq, chainSettings.lowCutSlope, sampleRate);
+}
+
+CutCoefficients makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return makeHighCutFilter(chainSettings.highCutFreq, chainSettings.highCutSlope, sampleRate);
+}
+
+UserBandCoefficients makeUserBandFilter(const UserBandSettings& band, PeakDesign bellDesign, double sampleRate)
+{
+    UserBandCoefficients coefficients;
+    coefficients.numSections = 1;
+
+    auto frequency = limitFrequency(juce::jmax(2.0, (double)band.freq), sampleRate);
+    auto Q = juce::jmax(0.01, (double)band.quality);
+    auto gainFactor = juce::Decibels::decibelsToGain((double)band.gainInDecibels);
+
+    switch (band.type)
+    {
+        case BandType::BandType_Bell:
+            coefficients.sections[0] = makeBellSection(band.freq, band.quality, band.gainInDecibels,
+                                                       bellDesign, sampleRate);
+            break;
+
+        case BandType::BandType_LowShelf:
+        case BandType::BandType_HighShelf:
+            coefficients.sections[0] = makeShelfSection(band.type == BandType::BandType_HighShelf,
+                                                        frequency, Q, gainFactor, sampleRate);
+            break;
+
+        case BandType::BandType_Notch:
+            coefficients.sections[0] = makeNotchSection(frequency, Q, sampleRate);
+            break;
+
+        case BandType::BandType_LowCut:
+        case BandType::BandType_HighCut:
+        {
+            auto cut = band.type == BandType::BandType_LowCut ? makeLowCutFilter(band.freq, band.slope, sampleRate)
+                                                               : makeHighCutFilter(band.freq, band.slope, sampleRate);
+
+            coefficients.sections = cut.sections;
+            coefficients.numSections = cut.numSections;
+            break;
+        }
+    }
+
+    return coefficients;
+}
+
+int designUserBands(ChainCoefficients& chainCoefficients)
+{
+    const auto& chainSettings = chainCoefficients.settings;
+    int numDesigns = 0;
+
+    for (int i = 0; i < MaxUserBands; ++i)
+    {
+        auto& band = chainCoefficients.userBands[(size_t)i];
+
+        if (isUserBandActive(chainSettings, i))
+        {
+            band = makeUserBandFilter(chainSettings.userBands[(size_t)i], chainSettings.peakDesign,
+                                      chainCoefficients.sampleRate);
+            ++numDesigns;
+        }
+        else
+        {
+            band.numSections = 0;
+        }
+    }
+
+    return numDesigns;
+}
+
+ParallelCutCoefficients makeParallelForm(const CutCoefficients& cut)
+{
+    using Complex = std::complex<double>;
+
+    ParallelCutCoefficients parallel;
+    parallel.numSections = cut.numSections;
+
+    // The constant term is H at z^-1 = 0 minus what the sections contribute there.
+    parallel.direct = 1.0;
+
+    for (int i = 0; i < cut.numSections; ++i)
+        parallel.direct *= cut.sections[i].b0;
+
+    for (int k = 0; k < cut.numSections; ++k)
+    {
+        const auto& section = cut.sections[k];
+
+        // 1 + a1 z^-1 + a2 z^-2 = (1 - p z^-1)(1 - conj(p) z^-1)
+        auto pole = (-section.a1 + std::sqrt(Complex(section.a1 * section.a1 - 4.0 * section.a2))) * 0.5;
+        auto w = 1.0 / pole; // z^-1 at the pole
+
+        auto numerator = [w](const BiquadCoefficients& c) { return c.b0 + c.b1 * w + c.b2 * w * w; };
+        auto denominator = [w](const BiquadCoefficients& c) { return 1.0 + c.a1 * w + c.a2 * w * w; };
+
+        // Residue at p: everything but this section's (1 - p z^-1) factor, evaluated at the pole.
+        auto residue = numerator(section) / (1.0 - std::conj(pole) * w);
+
+        for (int i = 0; i < cut.numSections; ++i)
+            if (i != k)
+                residue *= numerator(cut.sections[i]) / denominator(cut.sections[i]);
+
+        // r / (1 - p z^-1) + conj(r) / (1 - conj(p) z^-1), folded back into one real section.
+        auto& out = parallel.sections[k];
+        out.b0 = 2.0 * residue.real();
+        out.b1 = -2.0 * (residue * std::conj(pole)).real();
+        out.a1 = section.a1;
+        out.a2 = section.a2;
+
+        parallel.direct -= out.b0;
+    }
+
+    return parallel;
+}
+
+double getParallelFormErrorInDecibels(const CutCoefficients& cut, double sampleRate)
+{
+    auto parallel = makeParallelForm(cut);
+    auto maxError = 0.0;
+
+    // Same kind of sweep the response curve draws, but skip the stopband floor where both are ~0.
+    for (auto frequency = 20.0; frequency < sampleRate * 0.5; frequency *= 1.05)
+    {
+        auto cascadeDb = juce::Decibels::gainToDecibels(cut.getMagnitudeForFrequency(frequency, sampleRate), -200.0);
+        auto parallelDb = juce::Decibels::gainToDecibels(parallel.getMagnitudeForFrequency(frequency, sampleRate), -200.0);
+
+        if (cascadeDb > -120.0)
+            maxError = juce::jmax(maxError, std::abs(cascadeDb - parallelDb));
+    }
+
+    return maxError;
+}
+
+bool usesParallelForm(const ChainSettings& chainSettings, const CutCoefficients& cut)
+{
+    if (chainSettings.cutStructure != CutStructure::CutStructure_Parallel || cut.numSections <= 1)
+        return false;
+
+    // Near DC the residues are huge and have to cancel, the float parallel sections
+    // can't do that. The cascade gets double sections there instead.
+    for (int i = 0; i < cut.numSections; ++i)
+        if (cut.sections[i].hasPolesNearDC())
+            return false;
+
+    return true;
+}
+
+void designBand(ChainCoefficients& chainCoefficients, ChainPositions band)
+{
+    const auto& chainSettings = chainCoefficients.settings;
+    auto sampleRate = chainCoefficients.sampleRate;
+
+    switch (band)
+    {
+        case ChainPositions::LowCut:
+            chainCoefficients.lowCut = makeLowCutFilter(chainSettings, sampleRate);
+
+            if (usesParallelForm(chainSettings, chainCoefficients.lowCut))
+                chainCoefficients.lowCut.parallel = makeParallelForm(chainCoefficients.lowCut);
+            break;
+
+        case ChainPositions::Peak:
+            chainCoefficients.peak = makePeakFilter(chainSettings, sampleRate);
+            break;
+
+        case ChainPositions::HighCut:
+            chainCoefficients.highCut = makeHighCutFilter(chainSettings, sampleRate);
+
+            if (usesParallelForm(chainSettings, chainCoefficients.highCut))
+                chainCoefficients.highCut.parallel = makeParallelForm(chainCoefficients.highCut);
+            break;
+    }
+}
+
+double getChainMagnitudeForFrequency(const ChainCoefficients& chainCoefficients, double frequency)
+{
+    const auto& chainSettings = chainCoefficients.settings;
+    auto sampleRate = chainCoefficients.sampleRate;
+    auto magnitude = 1.0;
+
+    if (isBandActive(chainSettings, ChainPositions::Peak))
+        magnitude *= chainCoefficients.peak.getMagnitudeForFrequency(frequency, sampleRate);
+
+    if (isBandActive(chainSettings, ChainPositions::LowCut))
+        magnitude *= chainCoefficients.lowCut.getMagnitudeForFrequency(frequency, sampleRate);
+
+    if (isBandActive(chainSettings, ChainPositions::HighCut))
+        magnitude *= chainCoefficients.highCut.getMagnitudeForFrequency(frequency, sampleRate);
+
+    for (int i = 0; i < chainSettings.numUserBands; ++i)
+        if (isUserBandActive(chainSettings, i))
+            magnitude *= chainCoefficients.userBands[(size_t)i].getMagnitudeForFrequency(frequency, sampleRate);
+
+    return magnitude;
+}
+
+namespace
+{
+    double getDecayInSamples(const BiquadCoefficients& c)
+    {
+        auto radius = c.getPoleRadius();
+
+        // Unstable or on the unit circle: never settles, the caller caps it.
+        if (radius >= 1.0)
+            return std::numeric_limits<double>::infinity();
+
+        // Poles at the origin (FIR): two samples and it's done.
+        if (radius <= 0.0)
+            return 2.0;
+
+        return 2.0 + std::log(juce::Decibels::decibelsToGain(TailDecibels, -1000.0)) / std::log(radius);
+    }
+}
+
+double getChainTailInSeconds(const ChainCoefficients& chainCoefficients)
+{
+    const auto& chainSettings = chainCoefficients.settings;
+    auto samples = 0.0;
+
+    auto addCut = [&samples](const CutCoefficients& cut)
+    {
+        for (int i = 0; i < cut.numSections; ++i)
+            samples += getDecayInSamples(cut.sections[(size_t)i]);
+    };
+
+    if (isBandActive(chainSettings, ChainPositions::LowCut))
+        addCut(chainCoefficients.lowCut);
+
+    if (isBandActive(chainSettings, ChainPositions::Peak))
+        samples += getDecayInSamples(chainCoefficients.peak);
+
+    if (isBandActive(chainSettings, ChainPositions::HighCut))
+        addCut(chainCoefficients.highCut);
+
+    for (int i = 0; i < chainSettings.numUserBands; ++i)
+    {
+        if (isUserBandActive(chainSettings, i))
+        {
+            const auto& band = chainCoefficients.userBands[(size_t)i];
+
+            for (int j = 0; j < band.numSections; ++j)
+                samples += getDecayInSamples(band.sections[(size_t)j]);
+        }
+    }
+
+    if (chainCoefficients.sampleRate <= 0.0)
+        return 0.0;
+
+    // Nothing we design rings for a minute, that would be a broken design.
+    return juce::jmin(60.0, samples / chainCoefficients.sampleRate);
+}
+
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate)
+{
+    ChainCoefficients coefficients;
+
+    coefficients.settings = chainSettings;
+    coefficients.sampleRate = sampleRate;
+
+    designBand(coefficients, ChainPositions::LowCut);
+    designBand(coefficients, ChainPositions::Peak);
+    designBand(coefficients, ChainPositions::HighCut);
+    designUserBands(coefficients);
+
+    return coefficients;
+}
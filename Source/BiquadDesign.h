@@ -0,0 +1,141 @@
+/*
+  ==============================================================================
+
+    BiquadDesign.h
+    Created: 16 Oct 2026 2:40:18pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include "ChainSettings.h"
+
+//==============================================================================
+// Plain-old-data biquad coefficients, already normalised by a0.
+// Same layout as juce::dsp::IIR::Coefficients (b0, b1, b2, a1, a2) so they can be
+// copied straight into a Filter without touching the heap.
+
+struct BiquadCoefficients
+{
+    double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+
+    double getMagnitudeForFrequency(double frequency, double sampleRate) const;
+
+    // True when the poles are so close to z = 1 (roughly below fs / 500) that float
+    // coefficients and state turn into noise and drift, e.g. a 48 dB low cut at 25 Hz / 192 kHz.
+    bool hasPolesNearDC() const;
+
+    // Largest pole radius. The impulse response dies down like radius^n.
+    double getPoleRadius() const;
+};
+
+constexpr int MaxCutSections = 4; // 48 dB/Oct = four biquads
+
+//==============================================================================
+// The same cut response in parallel form (partial fractions of the cascade):
+//
+//     H(z) = direct + sum_k (b0_k + b1_k z^-1) / (1 + a1_k z^-1 + a2_k z^-2)
+//
+// Every section sees the input directly, so their recursions don't wait on each
+// other and a 36/48 dB slope stops being a four deep serial dependency chain.
+// Each section keeps the poles of the matching cascade section.
+
+struct ParallelSection
+{
+    double b0 = 0.0, b1 = 0.0, a1 = 0.0, a2 = 0.0;
+};
+
+struct ParallelCutCoefficients
+{
+    double direct = 1.0;
+    std::array<ParallelSection, MaxCutSections> sections;
+    int numSections = 0;
+
+    double getMagnitudeForFrequency(double frequency, double sampleRate) const;
+};
+
+struct CutCoefficients
+{
+    std::array<BiquadCoefficients, MaxCutSections> sections;
+    int numSections = 1;
+
+    // Only filled in when the settings ask for CutStructure_Parallel (see designBand()).
+    ParallelCutCoefficients parallel;
+
+    double getMagnitudeForFrequency(double frequency, double sampleRate) const;
+};
+
+// A user band: one biquad, or up to four for a cut. Inactive bands have no sections.
+struct UserBandCoefficients
+{
+    std::array<BiquadCoefficients, MaxCutSections> sections;
+    int numSections = 0;
+
+    double getMagnitudeForFrequency(double frequency, double sampleRate) const;
+};
+
+// A complete coefficient set for one MonoChain, plus the settings it was designed from.
+struct ChainCoefficients
+{
+    ChainSettings settings;
+    double sampleRate = 0.0;
+
+    CutCoefficients lowCut, highCut;
+    BiquadCoefficients peak;
+
+    std::array<UserBandCoefficients, MaxUserBands> userBands;
+};
+
+//==============================================================================
+// Allocation-free designers. The formulas are the ones juce::dsp::IIR::Coefficients
+// and juce::dsp::FilterDesign use, evaluated in double. A cut design costs a single
+// tan() no matter the slope (the Butterworth Qs come from a table).
+// The peak is the RBJ bell, or with PeakDesign_Matched a bell matched to the analog
+// magnitude (exp/cos instead of tan, still no allocation).
+
+BiquadCoefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+
+CutCoefficients makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate);
+CutCoefficients makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate);
+
+CutCoefficients makeLowCutFilter(float frequency, Slope slope, double sampleRate);
+CutCoefficients makeHighCutFilter(float frequency, Slope slope, double sampleRate);
+
+// Bells follow "Peak Design" like the peak band, shelves and notch are RBJ.
+UserBandCoefficients makeUserBandFilter(const UserBandSettings& band, PeakDesign bellDesign, double sampleRate);
+
+ChainCoefficients makeChainCoefficients(const ChainSettings& chainSettings, double sampleRate);
+
+// Redesigns a single band of the set from its own settings/sampleRate (cheap enough for control rate).
+void designBand(ChainCoefficients& chainCoefficients, ChainPositions band);
+
+// Redesigns every active user band (the others are left with no sections). Returns how many it designed.
+int designUserBands(ChainCoefficients& chainCoefficients);
+
+// |H(f)| of the whole chain, bypasses and slopes included, evaluated at the rate the set was designed for.
+// Same curve ResponseCurveComponent draws, the linear phase kernel is built from it.
+double getChainMagnitudeForFrequency(const ChainCoefficients& chainCoefficients, double frequency);
+
+// How long the chain keeps ringing after the input stops, until it's down by TailDecibels.
+// Every active section's decay time from its pole radius, added up (the cascade can't
+// outlast its sections one after another). Bypassed and neutral bands don't ring.
+constexpr double TailDecibels = -120.0;
+
+double getChainTailInSeconds(const ChainCoefficients& chainCoefficients);
+
+int getNumCutSections(Slope slope);
+
+// Partial fraction expansion of a cascade of biquads with distinct complex poles
+// (true for every Butterworth cut we design). Allocation free, a handful of complex ops per section.
+ParallelCutCoefficients makeParallelForm(const CutCoefficients& cut);
+
+// Worst deviation in dB between the parallel form and its cascade over a log sweep, 20 Hz - Nyquist.
+double getParallelFormErrorInDecibels(const CutCoefficients& cut, double sampleRate);
+
+// The parallel form only pays off with more than one section, a 12 dB/Oct cut always runs as a biquad.
+// A cut with poles near DC runs as a cascade too, whatever "Cut Structure" says.
+bool usesParallelForm(const ChainSettings& chainSettings, const CutCoefficients& cut);
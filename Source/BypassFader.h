@@ -0,0 +1,200 @@
+/*
+  ==============================================================================
+
+    BypassFader.h
+    Created: 17 Oct 2026 6:02:37pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+
+//==============================================================================
+// The dry side of skipping the whole chain: host bypass (processBlockBypassed())
+// or every band bypassed or neutral.
+//
+// The input always goes through a delay line as long as the current latency, so
+// the dry signal lines up with the processed one and the host's delay compensation
+// doesn't care which one it gets. While the chain runs and nothing fades, only
+// the samples a fade could still need (the last 'latency' of each block) go in. Switching between them is a short linear
+// crossfade. While fully bypassed the owner doesn't run the chain at all, the
+// delay line is the whole cost.
+
+template<typename SampleType>
+struct BypassFader
+{
+    // Not realtime safe.
+    void prepare(int numChannels, int maximumBlockSize, int maximumLatency)
+    {
+        delayLength = maximumLatency + 1;
+
+        delayLines.setSize(juce::jmax(1, numChannels), delayLength);
+        dryBuffer.setSize(juce::jmax(1, numChannels), juce::jmax(1, maximumBlockSize));
+
+        reset(processing);
+    }
+
+    void reset(bool shouldProcess)
+    {
+        delayLines.clear();
+        writePosition = 0;
+
+        processing = shouldProcess;
+        fadeSamplesLeft = 0;
+    }
+
+    void setCrossfadeLength(int numSamples)
+    {
+        crossfadeLength = juce::jmax(0, numSamples);
+        fadeSamplesLeft = juce::jmin(fadeSamplesLeft, crossfadeLength);
+    }
+
+    // Audio thread. Starts a crossfade towards the processed (true) or the dry signal.
+    // A chain that was reset needs its latency's worth of samples before its output
+    // means anything, primingSamples holds the fade off for that long.
+    void setProcessing(bool shouldProcess, int primingSamples = 0)
+    {
+        if (shouldProcess == processing)
+            return;
+
+        processing = shouldProcess;
+
+        // Turned around mid-fade: go back from where it is.
+        if (fadeSamplesLeft > 0)
+            fadeSamplesLeft = juce::jlimit(0, crossfadeLength, crossfadeLength - fadeSamplesLeft);
+        else
+            fadeSamplesLeft = crossfadeLength + (shouldProcess ? primingSamples : 0);
+    }
+
+    bool isBypassed() const { return !processing && fadeSamplesLeft == 0; }
+    bool isFading() const { return fadeSamplesLeft > 0; }
+
+    // Largest block mixIn() takes in one go.
+    int getMaximumBlockSize() const { return dryBuffer.getNumSamples(); }
+
+    // Fully bypassed: the block becomes its input delayed by 'latency'.
+    void processBypassed(juce::dsp::AudioBlock<SampleType>& block, int latency)
+    {
+        delay(block, latency, block);
+    }
+
+    // Before the chain runs on this block. Only keeps the delay line going, unless
+    // a fade is on, then the delayed input is kept for mixIn().
+    void pushInput(const juce::dsp::AudioBlock<SampleType>& block, int latency)
+    {
+        if (isFading())
+        {
+            jassert((int)block.getNumSamples() <= getMaximumBlockSize());
+
+            juce::dsp::AudioBlock<SampleType> dry(dryBuffer);
+            delay(block, latency, dry.getSubBlock(0, block.getNumSamples()));
+        }
+        else
+        {
+            writeTail(block, latency);
+        }
+    }
+
+    // After the chain ran on the block pushInput() got.
+    void mixIn(juce::dsp::AudioBlock<SampleType>& block)
+    {
+        if (!isFading())
+            return;
+
+        auto numChannels = juce::jmin((int)block.getNumChannels(), dryBuffer.getNumChannels());
+        auto numSamples = (int)block.getNumSamples();
+
+        auto length = (SampleType)juce::jmax(1, crossfadeLength);
+        auto position = (SampleType)(crossfadeLength - fadeSamplesLeft); // negative while priming
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* wet = block.getChannelPointer((size_t)ch);
+            auto* dry = dryBuffer.getReadPointer(ch);
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto progress = juce::jlimit((SampleType)0, (SampleType)1, (position + (SampleType)i) / length);
+                auto gain = processing ? progress : (SampleType)1 - progress;
+
+                wet[i] = dry[i] + gain * (wet[i] - dry[i]);
+            }
+        }
+
+        fadeSamplesLeft = juce::jmax(0, fadeSamplesLeft - numSamples);
+    }
+
+private:
+    juce::AudioBuffer<SampleType> delayLines, dryBuffer;
+    int delayLength = 1, writePosition = 0;
+
+    bool processing = true;
+    int crossfadeLength = 0, fadeSamplesLeft = 0;
+
+    // Nobody reads this block now: only its last 'latency' samples can still come out of
+    // the line later, copy just those in (nothing at all with no latency).
+    void writeTail(const juce::dsp::AudioBlock<SampleType>& block, int latency)
+    {
+        auto numChannels = juce::jmin((int)block.getNumChannels(), delayLines.getNumChannels());
+        auto numSamples = (int)block.getNumSamples();
+        auto numToKeep = juce::jmin(numSamples, juce::jlimit(0, delayLength - 1, latency));
+
+        if (numToKeep > 0)
+        {
+            auto start = (writePosition + numSamples - numToKeep) % delayLength;
+            auto first = juce::jmin(numToKeep, delayLength - start);
+
+            for (int ch = 0; ch < numChannels; ++ch)
+            {
+                auto* line = delayLines.getWritePointer(ch);
+                auto* tail = block.getChannelPointer((size_t)ch) + (numSamples - numToKeep);
+
+                juce::FloatVectorOperations::copy(line + start, tail, first);
+                juce::FloatVectorOperations::copy(line, tail + first, numToKeep - first);
+            }
+        }
+
+        writePosition = (writePosition + numSamples) % delayLength;
+    }
+
+    // Writes the block into the delay lines and reads it back 'latency' samples later
+    // into 'destination' (may be the block itself).
+    void delay(const juce::dsp::AudioBlock<SampleType>& block, int latency,
+               const juce::dsp::AudioBlock<SampleType>& destination)
+    {
+        jassert(latency < delayLength);
+
+        auto numChannels = juce::jmin((int)block.getNumChannels(), delayLines.getNumChannels());
+        auto numSamples = (int)block.getNumSamples();
+        latency = juce::jlimit(0, delayLength - 1, latency);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* line = delayLines.getWritePointer(ch);
+            auto* data = block.getChannelPointer((size_t)ch);
+            auto* out = destination.getChannelPointer((size_t)ch);
+            auto position = writePosition;
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                line[position] = data[i];
+
+                auto readPosition = position - latency;
+
+                if (readPosition < 0)
+                    readPosition += delayLength;
+
+                out[i] = line[readPosition];
+
+                if (++position == delayLength)
+                    position = 0;
+            }
+        }
+
+        writePosition = (writePosition + numSamples) % delayLength;
+    }
+};
@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    ChainOversampler.h
+    Created: 17 Oct 2026 1:12:55pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <memory>
+
+//==============================================================================
+// "Oversampling" choices. The order is the juce::dsp::Oversampling "factor":
+// the chain runs at (1 << order) times the host rate.
+
+constexpr int MaxOversamplingOrder = 3; // 8x
+
+inline juce::StringArray getOversamplingChoices()
+{
+    return { "1x", "2x", "4x", "8x" };
+}
+
+inline int getOversamplingFactor(int order)
+{
+    return 1 << juce::jlimit(0, MaxOversamplingOrder, order);
+}
+
+//==============================================================================
+// Runs a processor (the SIMDChain) at 1x/2x/4x/8x the host rate so the bells
+// stop cramping near Nyquist.
+//
+// Uses juce::dsp::Oversampling with polyphase IIR half-band stages (cheapest per
+// stage, small latency) and integer latency so the host can compensate exactly.
+// One oversampler per order is built in prepare(), switching order on the audio
+// thread just picks another one and resets it, nothing is allocated after prepare.
+
+template<typename SampleType>
+struct ChainOversampler
+{
+    // Not realtime safe.
+    void prepare(int numChannels, int maximumBlockSize)
+    {
+        for (int order = 1; order <= MaxOversamplingOrder; ++order)
+        {
+            auto& oversampler = oversamplers[(size_t)order];
+
+            oversampler = std::make_unique<juce::dsp::Oversampling<SampleType>>(
+                              (size_t)juce::jmax(1, numChannels), (size_t)order,
+                              juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR,
+                              true,   //max quality
+                              true);  //integer latency
+
+            oversampler->initProcessing((size_t)maximumBlockSize);
+            latencies[(size_t)order] = juce::roundToInt(oversampler->getLatencyInSamples());
+        }
+
+        latencies[0] = 0;
+        currentOrder = 0;
+    }
+
+    // Audio thread. The chain has to get coefficients designed for the new rate along with this.
+    void setOrder(int newOrder)
+    {
+        newOrder = juce::jlimit(0, MaxOversamplingOrder, newOrder);
+
+        if (newOrder == currentOrder)
+            return;
+
+        currentOrder = newOrder;
+
+        if (auto* oversampler = oversamplers[(size_t)currentOrder].get())
+            oversampler->reset();
+    }
+
+    int getOrder() const { return currentOrder; }
+
+    void reset()
+    {
+        if (auto* oversampler = oversamplers[(size_t)currentOrder].get())
+            oversampler->reset();
+    }
+
+    // In host rate samples.
+    int getLatencyInSamples(int order) const { return latencies[(size_t)juce::jlimit(0, MaxOversamplingOrder, order)]; }
+
+    template<typename Processor>
+    void process(juce::dsp::AudioBlock<SampleType>& block, Processor& processor)
+    {
+        auto* oversampler = oversamplers[(size_t)currentOrder].get();
+
+        if (oversampler == nullptr)
+        {
+            processor.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+            return;
+        }
+
+        auto oversampledBlock = oversampler->processSamplesUp(block);
+        processor.process(juce::dsp::ProcessContextReplacing<SampleType>(oversampledBlock));
+        oversampler->processSamplesDown(block);
+    }
+
+private:
+    std::array<std::unique_ptr<juce::dsp::Oversampling<SampleType>>, MaxOversamplingOrder + 1> oversamplers; // [0] stays empty
+    std::array<int, MaxOversamplingOrder + 1> latencies {};
+    int currentOrder = 0;
+};
@@ -0,0 +1,318 @@
+/*
+  ==============================================================================
+
+    ChainSettings.cpp
+    Created: 16 Oct 2026 10:12:41am
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#include "ChainSettings.h"
+
+//==============================================================================
+
+ChainParameterHandles::ChainParameterHandles(juce::AudioProcessorValueTreeState& apvts, int channelSet) :
+lowCutFreq(apvts.getRawParameterValue(getChannelSetPrefix(channelSet) + "LowCut Freq")),
+highCutFreq(apvts.getRawParameterValue(getChannelSetPrefix(channelSet) + "HighCut Freq")),
+lowCutSlope(apvts.getRawParameterValue(getChannelSetPrefix(channelSet) + "LowCut Slope")),
+highCutSlope(apvts.getRawParameterValue(getChannelSetPrefix(channelSet) + "HighCut Slope")),
+peakFreq(apvts.getRawParameterValue(getChannelSetPrefix(channelSet) + "Peak Freq")),
+peakGain(apvts.getRawParameterValue(getChannelSetPrefix(channelSet) + "Peak Gain")),
+peakQuality(apvts.getRawParameterValue(getChannelSetPrefix(channelSet) + "Quality")),
+lowCutBypassed(apvts.getRawParameterValue(getChannelSetPrefix(channelSet) + "LowCut Bypassed")),
+highCutBypassed(apvts.getRawParameterValue(getChannelSetPrefix(channelSet) + "HighCut Bypassed")),
+peakBypassed(apvts.getRawParameterValue(getChannelSetPrefix(channelSet) + "Peak Bypassed")),
+peakDesign(apvts.getRawParameterValue("Peak Design")),
+peakDynamic(apvts.getRawParameterValue("Peak Dynamic")),
+cutStructure(apvts.getRawParameterValue("Cut Structure")),
+oversampling(apvts.getRawParameterValue("Oversampling")),
+numUserBands(apvts.getRawParameterValue("Band Count")),
+firstSet(channelSet == 0)
+{
+    jassert(lowCutFreq != nullptr && highCutFreq != nullptr
+            && lowCutSlope != nullptr && highCutSlope != nullptr
+            && peakFreq != nullptr && peakGain != nullptr && peakQuality != nullptr
+            && lowCutBypassed != nullptr && highCutBypassed != nullptr && peakBypassed != nullptr
+            && peakDesign != nullptr && peakDynamic != nullptr && cutStructure != nullptr && oversampling != nullptr
+            && numUserBands != nullptr);
+
+    // The second set runs the first set's user bands, it doesn't need their handles.
+    for (int i = 0; i < (firstSet ? MaxUserBands : 0); ++i)
+    {
+        auto& band = userBands[(size_t)i];
+
+        band.type = apvts.getRawParameterValue(getUserBandParameterID(i, "Type"));
+        band.freq = apvts.getRawParameterValue(getUserBandParameterID(i, "Freq"));
+        band.gain = apvts.getRawParameterValue(getUserBandParameterID(i, "Gain"));
+        band.quality = apvts.getRawParameterValue(getUserBandParameterID(i, "Q"));
+        band.slope = apvts.getRawParameterValue(getUserBandParameterID(i, "Slope"));
+        band.bypassed = apvts.getRawParameterValue(getUserBandParameterID(i, "Bypassed"));
+
+        jassert(band.type != nullptr && band.freq != nullptr && band.gain != nullptr
+                && band.quality != nullptr && band.slope != nullptr && band.bypassed != nullptr);
+    }
+}
+
+ChainSettings ChainParameterHandles::load() const
+{
+    ChainSettings settings;
+
+    //HPF y LPF
+    settings.lowCutFreq = lowCutFreq->load();
+    settings.highCutFreq = highCutFreq->load();
+    settings.lowCutSlope = static_cast<Slope>(lowCutSlope->load());
+    settings.highCutSlope = static_cast<Slope>(highCutSlope->load());
+
+    //Bell
+    settings.peakFreq = peakFreq->load();
+    settings.peakGainInDecibels = peakGain->load();
+    settings.peakQuality = peakQuality->load();
+    settings.peakDesign = static_cast<PeakDesign>(peakDesign->load());
+    settings.peakDynamic = firstSet && peakDynamic->load() > 0.5f;
+
+    //Bypass Settings
+    settings.lowCutBypassed = lowCutBypassed->load() > 0.5f;
+    settings.highCutBypassed = highCutBypassed->load() > 0.5f;
+    settings.peakBypassed = peakBypassed->load() > 0.5f;
+
+    settings.cutStructure = static_cast<CutStructure>(cutStructure->load());
+    settings.oversamplingOrder = juce::roundToInt(oversampling->load());
+
+    //User bands, the ones past "Band Count" are loaded too, they just don't run
+    if (!firstSet)
+        return settings;
+
+    settings.numUserBands = juce::jlimit(0, MaxUserBands, juce::roundToInt(numUserBands->load()));
+
+    for (int i = 0; i < MaxUserBands; ++i)
+    {
+        const auto& handles = userBands[(size_t)i];
+        auto& band = settings.userBands[(size_t)i];
+
+        band.type = static_cast<BandType>(juce::roundToInt(handles.type->load()));
+        band.freq = handles.freq->load();
+        band.gainInDecibels = handles.gain->load();
+        band.quality = handles.quality->load();
+        band.slope = static_cast<Slope>(juce::roundToInt(handles.slope->load()));
+        band.bypassed = handles.bypassed->load() > 0.5f;
+    }
+
+    return settings;
+}
+
+ChainSettings getChainSettings (juce::AudioProcessorValueTreeState& apvts){
+
+    return ChainParameterHandles(apvts).load();
+}
+
+bool isBandBypassed(const ChainSettings& chainSettings, ChainPositions band)
+{
+    switch (band)
+    {
+        case ChainPositions::LowCut:  return chainSettings.lowCutBypassed;
+        case ChainPositions::Peak:    return chainSettings.peakBypassed;
+        case ChainPositions::HighCut: return chainSettings.highCutBypassed;
+    }
+
+    return false;
+}
+
+bool isBandNeutral(const ChainSettings& chainSettings, ChainPositions band)
+{
+    switch (band)
+    {
+        case ChainPositions::LowCut:  return chainSettings.lowCutFreq <= MinCutFrequency;
+        case ChainPositions::Peak:    return chainSettings.peakGainInDecibels == 0.f && !chainSettings.peakDynamic;
+        case ChainPositions::HighCut: return chainSettings.highCutFreq >= MaxCutFrequency;
+    }
+
+    return false;
+}
+
+bool isBandActive(const ChainSettings& chainSettings, ChainPositions band)
+{
+    return !isBandBypassed(chainSettings, band) && !isBandNeutral(chainSettings, band);
+}
+
+bool isUserBandActive(const ChainSettings& chainSettings, int index)
+{
+    if (index >= chainSettings.numUserBands)
+        return false;
+
+    const auto& band = chainSettings.userBands[(size_t)index];
+
+    if (band.bypassed)
+        return false;
+
+    switch (band.type)
+    {
+        case BandType::BandType_Bell:
+        case BandType::BandType_LowShelf:
+        case BandType::BandType_HighShelf: return band.gainInDecibels != 0.f;
+        case BandType::BandType_Notch:     return true;
+        case BandType::BandType_LowCut:    return band.freq > MinCutFrequency;
+        case BandType::BandType_HighCut:   return band.freq < MaxCutFrequency;
+    }
+
+    return false;
+}
+
+bool isAnyBandActive(const ChainSettings& chainSettings)
+{
+    if (isBandActive(chainSettings, ChainPositions::LowCut)
+        || isBandActive(chainSettings, ChainPositions::Peak)
+        || isBandActive(chainSettings, ChainPositions::HighCut))
+        return true;
+
+    for (int i = 0; i < chainSettings.numUserBands; ++i)
+        if (isUserBandActive(chainSettings, i))
+            return true;
+
+    return false;
+}
+
+juce::StringArray getChannelModeChoices()
+{
+    return { "Stereo", "Left/Right", "Mid/Side" };
+}
+
+juce::String getChannelSetPrefix(int channelSet)
+{
+    return channelSet == 0 ? juce::String() : juce::String("Ch2 ");
+}
+
+juce::String getUserBandParameterID(int index, const juce::String& name)
+{
+    return "Band " + juce::String(index + 1) + " " + name;
+}
+
+juce::StringArray getChainParameterIDs(int channelSet)
+{
+    juce::StringArray ids;
+
+    for (auto name : { "LowCut Freq", "HighCut Freq", "LowCut Slope", "HighCut Slope", "Peak Freq", "Peak Gain",
+                       "Quality", "LowCut Bypassed", "HighCut Bypassed", "Peak Bypassed" })
+        ids.add(getChannelSetPrefix(channelSet) + name);
+
+    ids.addArray(juce::StringArray { "Peak Design", "Peak Dynamic", "Cut Structure", "Oversampling", "Band Count" });
+
+    // Same as the handles, the second set has no user bands of its own.
+    for (int i = 0; i < (channelSet == 0 ? MaxUserBands : 0); ++i)
+        for (auto name : { "Type", "Freq", "Gain", "Q", "Slope", "Bypassed" })
+            ids.add(getUserBandParameterID(i, name));
+
+    return ids;
+}
+
+juce::StringArray getBandTypeChoices()
+{
+    return { "Bell", "Low Shelf", "High Shelf", "Notch", "Low Cut", "High Cut" };
+}
+
+//==============================================================================
+
+ChainSettingsSnapshot::ChainSettingsSnapshot(juce::AudioProcessorValueTreeState& apvts, int channelSet) :
+handles(apvts, channelSet),
+settings(handles.load())
+{
+    // Start at 1 so an owner that zero-initialises its "applied" versions
+    // always designs everything on the first pass.
+    versions.fill(1);
+}
+
+bool ChainSettingsSnapshot::update()
+{
+    auto latest = handles.load();
+
+    bool changed = false;
+
+    if (settings.oversamplingOrder != latest.oversamplingOrder)
+    {
+        invalidate();
+        changed = true;
+    }
+
+    if (lowCutDiffers(settings, latest))
+    {
+        ++versions[ChainPositions::LowCut];
+        changed = true;
+    }
+
+    if (peakDiffers(settings, latest))
+    {
+        ++versions[ChainPositions::Peak];
+        changed = true;
+    }
+
+    if (highCutDiffers(settings, latest))
+    {
+        ++versions[ChainPositions::HighCut];
+        changed = true;
+    }
+
+    if (userBandsDiffer(settings, latest))
+    {
+        ++userBandsVersion;
+        changed = true;
+    }
+
+    settings = latest;
+
+    return changed;
+}
+
+void ChainSettingsSnapshot::invalidate()
+{
+    for (auto& v : versions)
+        ++v;
+
+    ++userBandsVersion;
+}
+
+bool ChainSettingsSnapshot::lowCutDiffers(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.lowCutFreq != b.lowCutFreq
+        || a.lowCutSlope != b.lowCutSlope
+        || a.lowCutBypassed != b.lowCutBypassed
+        || a.cutStructure != b.cutStructure;
+}
+
+bool ChainSettingsSnapshot::peakDiffers(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.peakFreq != b.peakFreq
+        || a.peakGainInDecibels != b.peakGainInDecibels
+        || a.peakQuality != b.peakQuality
+        || a.peakDesign != b.peakDesign
+        || a.peakDynamic != b.peakDynamic
+        || a.peakBypassed != b.peakBypassed;
+}
+
+bool ChainSettingsSnapshot::highCutDiffers(const ChainSettings& a, const ChainSettings& b)
+{
+    return a.highCutFreq != b.highCutFreq
+        || a.highCutSlope != b.highCutSlope
+        || a.highCutBypassed != b.highCutBypassed
+        || a.cutStructure != b.cutStructure;
+}
+
+
+bool ChainSettingsSnapshot::userBandsDiffer(const ChainSettings& a, const ChainSettings& b)
+{
+    // "Peak Design" applies to the user bells too.
+    if (a.numUserBands != b.numUserBands || a.peakDesign != b.peakDesign)
+        return true;
+
+    // Only the bands in use, moving a knob past "Band Count" changes nothing.
+    for (int i = 0; i < a.numUserBands; ++i)
+    {
+        const auto& x = a.userBands[(size_t)i];
+        const auto& y = b.userBands[(size_t)i];
+
+        if (x.type != y.type || x.freq != y.freq || x.gainInDecibels != y.gainInDecibels
+            || x.quality != y.quality || x.slope != y.slope || x.bypassed != y.bypassed)
+            return true;
+    }
+
+    return false;
+}
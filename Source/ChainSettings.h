@@ -0,0 +1,226 @@
+/*
+  ==============================================================================
+
+    ChainSettings.h
+    Created: 16 Oct 2026 10:12:41am
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+
+//==============================================================================
+
+enum Slope {
+
+    Slope_12,
+    Slope_24,
+    Slope_36,
+    Slope_48
+
+};
+
+// How the cut filters are run: the usual serial biquads, or the same response split
+// into parallel second order sections (independent recursions, see ParallelCutCoefficients).
+enum CutStructure {
+
+    CutStructure_Cascade,
+    CutStructure_Parallel
+
+};
+
+
+// How the bell is turned into a biquad: the usual RBJ bilinear design (cramps towards
+// Nyquist), or one matched to the analog bell's magnitude (see makePeakFilter()).
+enum PeakDesign {
+
+    PeakDesign_Bilinear,
+    PeakDesign_Matched
+
+};
+
+
+// What a user band is. The cuts use the band's slope, everything else is a single
+// biquad (RBJ shelves and notch, the bell is designed like the peak band).
+enum BandType {
+
+    BandType_Bell,
+    BandType_LowShelf,
+    BandType_HighShelf,
+    BandType_Notch,
+    BandType_LowCut,
+    BandType_HighCut
+
+};
+
+
+// "Channel Mode": both channels on the same settings, or (stereo buses only) each
+// of Left/Right or Mid/Side with its own set of the fixed bands. The first channel
+// (Left, Mid) uses the usual parameters, the second one the "Ch2 ..." copies.
+enum ChannelMode {
+
+    ChannelMode_Stereo,
+    ChannelMode_LeftRight,
+    ChannelMode_MidSide
+
+};
+
+constexpr int NumChannelSets = 2;
+
+juce::StringArray getChannelModeChoices();
+
+// Prefix of the second channel's parameters, "Ch2 LowCut Freq" and so on.
+juce::String getChannelSetPrefix(int channelSet);
+
+
+// Runtime bands ("Band Count" of them), after the fixed LowCut/Peak/HighCut.
+constexpr int MaxUserBands = 24;
+
+struct UserBandSettings {
+
+    BandType type { BandType::BandType_Bell };
+    float freq {1000.f}, gainInDecibels {0}, quality {0.71f};
+    Slope slope { Slope::Slope_12 };
+    bool bypassed {false};
+
+};
+
+
+struct ChainSettings {
+
+    float peakFreq {0}, peakGainInDecibels{0}, peakQuality{0};
+    float lowCutFreq{0}, highCutFreq{0};
+    Slope  lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
+    bool lowCutBypassed {false}, highCutBypassed {false}, peakBypassed{false};
+    CutStructure cutStructure { CutStructure::CutStructure_Cascade };
+    PeakDesign peakDesign { PeakDesign::PeakDesign_Bilinear };
+    bool peakDynamic {false}; // gain driven by DynamicPeak, "Peak Gain" is the range
+    int oversamplingOrder {0}; // the chain runs at (1 << order) x the host rate
+
+    int numUserBands {0};
+    std::array<UserBandSettings, MaxUserBands> userBands {};
+
+};
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+
+
+enum ChainPositions {
+    LowCut,
+    Peak,
+    HighCut
+};
+
+constexpr int NumChainPositions = 3;
+
+bool isBandBypassed(const ChainSettings& chainSettings, ChainPositions band);
+
+// The cut frequency knobs' end stops ("LowCut Freq" / "HighCut Freq" ranges).
+constexpr float MinCutFrequency = 20.f;
+constexpr float MaxCutFrequency = 20000.f;
+
+// A band that leaves the signal alone: a 0 dB bell, or a cut parked on its end stop
+// (20 Hz low cut, 20 kHz high cut count as off). It's skipped like a bypassed one.
+// A dynamic bell is never neutral, its gain moves.
+bool isBandNeutral(const ChainSettings& chainSettings, ChainPositions band);
+
+// Not bypassed and not neutral, i.e. the band actually has to run.
+bool isBandActive(const ChainSettings& chainSettings, ChainPositions band);
+
+// Same for a user band: past "Band Count", bypassed, a 0 dB bell/shelf or a cut on
+// its end stop doesn't run. A notch always cuts something.
+bool isUserBandActive(const ChainSettings& chainSettings, int index);
+
+bool isAnyBandActive(const ChainSettings& chainSettings);
+
+// "Band N Type", "Band N Freq", ... with N counting from 1 like the UI.
+juce::String getUserBandParameterID(int index, const juce::String& name);
+juce::StringArray getBandTypeChoices();
+
+//==============================================================================
+// Cached parameter handles.
+// getRawParameterValue() is a string lookup, so we only do it once per instance
+// and keep the atomics around for the audio thread.
+
+struct ChainParameterHandles
+{
+    // channelSet 1 reads the "Ch2 ..." copies of the fixed bands. The rest is shared,
+    // except for what only the first set has: the dynamic bell and the user bands.
+    explicit ChainParameterHandles(juce::AudioProcessorValueTreeState& apvts, int channelSet = 0);
+
+    ChainSettings load() const;
+
+    std::atomic<float>* lowCutFreq;
+    std::atomic<float>* highCutFreq;
+    std::atomic<float>* lowCutSlope;
+    std::atomic<float>* highCutSlope;
+
+    std::atomic<float>* peakFreq;
+    std::atomic<float>* peakGain;
+    std::atomic<float>* peakQuality;
+
+    std::atomic<float>* lowCutBypassed;
+    std::atomic<float>* highCutBypassed;
+    std::atomic<float>* peakBypassed;
+    std::atomic<float>* peakDesign;
+    std::atomic<float>* peakDynamic;
+
+    std::atomic<float>* cutStructure;
+    std::atomic<float>* oversampling;
+
+    struct UserBand
+    {
+        std::atomic<float>* type;
+        std::atomic<float>* freq;
+        std::atomic<float>* gain;
+        std::atomic<float>* quality;
+        std::atomic<float>* slope;
+        std::atomic<float>* bypassed;
+    };
+
+    std::atomic<float>* numUserBands;
+    std::array<UserBand, MaxUserBands> userBands {};
+
+    bool firstSet;
+};
+
+// Every parameter ID the handles of a channel set read, to listen to them.
+juce::StringArray getChainParameterIDs(int channelSet = 0);
+
+//==============================================================================
+// Parameter snapshot with a change version per band.
+// Every call to update() reads the cached handles and bumps the version of the
+// bands (LowCut, Peak, HighCut) whose parameters moved since the last call, so
+// the owner only has to redesign what actually changed. A new oversampling order
+// changes the design rate, so it bumps all of them. The user bands share one
+// version, any of them moving (or "Band Count") bumps it.
+
+struct ChainSettingsSnapshot
+{
+    explicit ChainSettingsSnapshot(juce::AudioProcessorValueTreeState& apvts, int channelSet = 0);
+
+    // Returns true if any band changed.
+    bool update();
+
+    const ChainSettings& getSettings() const { return settings; }
+    juce::uint32 getVersion(ChainPositions band) const { return versions[band]; }
+    juce::uint32 getUserBandsVersion() const { return userBandsVersion; }
+
+    // Forces every band to look "changed" (e.g. after a sample rate change).
+    void invalidate();
+
+private:
+    ChainParameterHandles handles;
+    ChainSettings settings;
+    std::array<juce::uint32, NumChainPositions> versions;
+    juce::uint32 userBandsVersion = 1;
+
+    static bool lowCutDiffers(const ChainSettings& a, const ChainSettings& b);
+    static bool peakDiffers(const ChainSettings& a, const ChainSettings& b);
+    static bool highCutDiffers(const ChainSettings& a, const ChainSettings& b);
+    static bool userBandsDiffer(const ChainSettings& a, const ChainSettings& b);
+};
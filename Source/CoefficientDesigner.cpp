@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    CoefficientDesigner.cpp
+    Created: 16 Oct 2026 3:05:47pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#include "CoefficientDesigner.h"
+#include "ChainOversampler.h"
+
+//==============================================================================
+
+ParameterWatcher::ParameterWatcher(juce::AudioProcessorValueTreeState& apvts, const juce::StringArray& parameterIDs,
+                                   juce::TimeSliceThread& threadToWake, juce::TimeSliceClient& clientToWake) :
+state(apvts),
+ids(parameterIDs),
+thread(threadToWake),
+client(clientToWake)
+{
+    for (const auto& id : ids)
+        state.addParameterListener(id, this);
+}
+
+ParameterWatcher::~ParameterWatcher()
+{
+    for (const auto& id : ids)
+        state.removeParameterListener(id, this);
+}
+
+void ParameterWatcher::setEnabled(bool shouldBeEnabled)
+{
+    if (enabled.exchange(shouldBeEnabled) == shouldBeEnabled)
+        return;
+
+    if (shouldBeEnabled && pending.load())
+        thread.moveToFrontOfQueue(&client);
+}
+
+void ParameterWatcher::parameterChanged(const juce::String&, float)
+{
+    if (!pending.exchange(true) && enabled.load())
+        thread.moveToFrontOfQueue(&client);
+}
+
+//==============================================================================
+
+CoefficientDesigner::CoefficientDesigner(juce::AudioProcessorValueTreeState& apvts, DesignCounter& counter, int channelSet) :
+snapshot(apvts, channelSet),
+designCounter(counter),
+watcher(apvts, getChainParameterIDs(channelSet), *thread, *this)
+{
+    thread->addTimeSliceClient(this);
+}
+
+CoefficientDesigner::~CoefficientDesigner()
+{
+    // Blocks until a running useTimeSlice() has finished.
+    thread->removeTimeSliceClient(this);
+}
+
+void CoefficientDesigner::prepare(double newSampleRate)
+{
+    const juce::ScopedLock sl(designLock);
+
+    sampleRate = newSampleRate;
+
+    // New sample rate: everything has to be redesigned.
+    designedVersions.fill(0);
+    designedUserBandsVersion = 0;
+    snapshot.update();
+
+    designChangedBands();
+    publish();
+}
+
+void CoefficientDesigner::triggerUpdate()
+{
+    thread->moveToFrontOfQueue(this);
+}
+
+int CoefficientDesigner::useTimeSlice()
+{
+    const juce::ScopedLock sl(designLock);
+
+    // Not prepared yet, or a set nobody runs. The changes wait in the watcher.
+    if (sampleRate <= 0.0 || !watcher.isEnabled())
+        return idleIntervalMs;
+
+    // Cleared first: a change that lands while we design comes straight back.
+    watcher.takeChanges();
+    snapshot.update();
+
+    if (designChangedBands())
+        publish();
+
+    return watcher.hasChanges() ? pollIntervalMs : idleIntervalMs;
+}
+
+bool CoefficientDesigner::designChangedBands()
+{
+    working.settings = snapshot.getSettings();
+    
+    // Design at the rate the chain actually runs at.
+    working.sampleRate = sampleRate * getOversamplingFactor(working.settings.oversamplingOrder);
+
+    bool changed = false;
+    int numDesigns = 0;
+
+    for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+    {
+        auto version = snapshot.getVersion(band);
+
+        if (designedVersions[band] == version)
+            continue;
+
+        designedVersions[band] = version;
+        changed = true;
+
+        // A bypassed (or neutral) band doesn't need new coefficients, turning it on bumps its version anyway.
+        if (isBandActive(working.settings, band))
+        {
+            designBand(working, band);
+            ++numDesigns;
+            
+            // The parallel form has to draw exactly the curve of the cascade it came from.
+            if (band != ChainPositions::Peak)
+            {
+                const auto& cut = band == ChainPositions::LowCut ? working.lowCut : working.highCut;
+                jassert(!usesParallelForm(working.settings, cut) || getParallelFormErrorInDecibels(cut, working.sampleRate) < 0.05);
+                juce::ignoreUnused(cut);
+            }
+        }
+    }
+
+    // The user bands are designed as a set, there can be 24 of them but a design is cheap.
+    if (designedUserBandsVersion != snapshot.getUserBandsVersion())
+    {
+        designedUserBandsVersion = snapshot.getUserBandsVersion();
+        changed = true;
+
+        numDesigns += designUserBands(working);
+    }
+
+    designCounter.addDesigns(numDesigns);
+
+    return changed;
+}
+
+void CoefficientDesigner::publish()
+{
+    coefficientBuffer.getWriteBuffer() = working;
+    coefficientBuffer.publish();
+}
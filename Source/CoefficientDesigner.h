@@ -0,0 +1,174 @@
+/*
+  ==============================================================================
+
+    CoefficientDesigner.h
+    Created: 16 Oct 2026 3:05:47pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "BiquadDesign.h"
+#include "TripleBuffer.h"
+
+//==============================================================================
+// Counts coefficient designs and turns them into a designs-per-second figure,
+// measured in audio time so an idle instance should read exactly 0.
+// addDesigns() can be called from any thread, advance() only from the audio thread.
+
+struct DesignCounter
+{
+    void prepare(double sampleRate)
+    {
+        samplesPerReport = juce::jmax(1, juce::roundToInt(sampleRate));
+        samplesElapsed = 0;
+        designsAtLastReport = totalDesigns.load();
+    }
+
+    void addDesigns(int numDesigns) { totalDesigns.fetch_add((juce::uint32)numDesigns); }
+
+    // Call once per block from the audio thread.
+    void advance(int numSamples)
+    {
+        samplesElapsed += numSamples;
+
+        if (samplesElapsed >= samplesPerReport)
+        {
+            auto total = totalDesigns.load();
+            auto designs = total - designsAtLastReport;
+
+            designsPerSecond.store((float)designs * (float)samplesPerReport / (float)samplesElapsed);
+
+            designsAtLastReport = total;
+            samplesElapsed = 0;
+        }
+    }
+
+    float getDesignsPerSecond() const { return designsPerSecond.load(); }
+
+private:
+    std::atomic<juce::uint32> totalDesigns {0};
+    std::atomic<float> designsPerSecond {0.f};
+    juce::uint32 designsAtLastReport = 0;
+    int samplesPerReport = 44100;
+    int samplesElapsed = 0;
+};
+
+//==============================================================================
+// One background thread shared by every EelEQ instance in the process.
+
+struct DesignerThread : juce::TimeSliceThread
+{
+    DesignerThread() : juce::TimeSliceThread("EelEQ Coefficient Designer")
+    {
+        startThread();
+    }
+
+    ~DesignerThread() override
+    {
+        stopThread(1000);
+    }
+};
+
+//==============================================================================
+// Wakes a designer up when one of its parameters moves, so an idle one doesn't poll.
+//
+// parameterChanged() comes from whichever thread set the value, the audio thread
+// included (automation). Only the first change since the designer last looked
+// moves it to the front of the queue, after that it's just a flag. Disabled, the
+// changes pile up in the flag and enabling wakes the designer if there were any.
+
+struct ParameterWatcher : juce::AudioProcessorValueTreeState::Listener
+{
+    ParameterWatcher(juce::AudioProcessorValueTreeState& apvts, const juce::StringArray& parameterIDs,
+                     juce::TimeSliceThread& threadToWake, juce::TimeSliceClient& clientToWake);
+    ~ParameterWatcher() override;
+
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const { return enabled.load(); }
+
+    // The designer thread, before it reads the parameters. True if any moved since the last call.
+    bool takeChanges() { return pending.exchange(false); }
+
+    // A change that came in while the designer was busy, it should come back straight away.
+    bool hasChanges() const { return pending.load(); }
+
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
+
+private:
+    juce::AudioProcessorValueTreeState& state;
+    juce::StringArray ids;
+    juce::TimeSliceThread& thread;
+    juce::TimeSliceClient& client;
+
+    std::atomic<bool> pending {true}, enabled {true};
+
+    JUCE_DECLARE_NON_COPYABLE(ParameterWatcher)
+};
+
+//==============================================================================
+// Designs the chain coefficients off the audio thread.
+//
+// The designer runs on the shared DesignerThread when a ParameterWatcher says its
+// parameters moved, redesigns only the bands whose version moved and publishes
+// the complete set through a TripleBuffer. The audio thread just calls
+// pullLatest(): one atomic exchange, no locks, no allocation, no refcounting.
+// With nothing moving it only looks in every idleIntervalMs, just in case.
+
+struct CoefficientDesigner : juce::TimeSliceClient
+{
+    // channelSet picks the parameters, see ChainParameterHandles.
+    CoefficientDesigner(juce::AudioProcessorValueTreeState& apvts, DesignCounter& counter, int channelSet = 0);
+    ~CoefficientDesigner() override;
+
+    // Message thread, audio stopped: designs everything for the new sample rate
+    // and publishes it straight away so the first block is already correct.
+    // sampleRate is the host rate, the "Oversampling" order gets applied on top of it.
+    void prepare(double sampleRate);
+
+    // Ask the thread to look at the parameters as soon as possible (preset loads).
+    void triggerUpdate();
+
+    // A set the chain doesn't run (the second one in "Stereo" mode) needn't be designed.
+    // Any thread. Enabling it again catches up on whatever moved in the meantime.
+    void setEnabled(bool shouldBeEnabled) { watcher.setEnabled(shouldBeEnabled); }
+
+    // Audio thread. Returns true if a newer set has been swapped in.
+    bool pullLatest() { return coefficientBuffer.acquire(); }
+    const ChainCoefficients& getLatest() const { return coefficientBuffer.getReadBuffer(); }
+
+    int useTimeSlice() override;
+
+private:
+    juce::SharedResourcePointer<DesignerThread> thread;
+
+    ChainSettingsSnapshot snapshot;
+    std::array<juce::uint32, NumChainPositions> designedVersions {};
+    juce::uint32 designedUserBandsVersion = 0;
+
+    ChainCoefficients working; // worker-side copy, only touched with designLock held
+    TripleBuffer<ChainCoefficients> coefficientBuffer;
+
+    DesignCounter& designCounter;
+
+    juce::CriticalSection designLock; // designer thread vs prepare(), never taken by the audio thread
+    double sampleRate = 0.0;
+
+    ParameterWatcher watcher;
+
+    // While the parameters keep moving (automation) it designs at most this often.
+    static constexpr int pollIntervalMs = 2;
+
+    // Parameter listeners can miss a change (the one that lands just as a slice returns), this catches it.
+    static constexpr int idleIntervalMs = 500;
+
+    // Redesigns the bands that changed and publishes. Caller holds designLock.
+    bool designChangedBands();
+    void publish();
+
+    JUCE_DECLARE_NON_COPYABLE(CoefficientDesigner)
+};
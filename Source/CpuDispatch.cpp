@@ -0,0 +1,466 @@
+/*
+  ==============================================================================
+
+    CpuDispatch.cpp
+    Created: 18 Oct 2026 12:31:07am
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#include "CpuDispatch.h"
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+// Target attributes are a GCC/Clang thing, MSVC builds only get the baseline. So does
+// a build that already targets AVX2, its SIMDRegisters are 8 floats wide.
+#if JUCE_INTEL && (JUCE_GCC || JUCE_CLANG) && ! defined (__AVX2__)
+ #define EELEQ_CPU_DISPATCH 1
+ #define EELEQ_TARGET(isa) __attribute__((target(isa)))
+ #if JUCE_CLANG
+  #define EELEQ_UNROLL _Pragma("unroll")
+ #else
+  #define EELEQ_UNROLL _Pragma("GCC unroll 16")
+ #endif
+ #include <immintrin.h>
+#else
+ #define EELEQ_CPU_DISPATCH 0
+#endif
+
+namespace
+{
+   #if EELEQ_CPU_DISPATCH
+    //==============================================================================
+    // The cascade, on the same 128 bit registers as SIMDRegister (4 float or 2 double
+    // lanes), with the states held in registers across the whole block. Force inlined
+    // into the per-level wrappers below, so it's compiled once for each of them.
+    //
+    // Separate multiplies and adds in SIMDChain's order, never fused: the output has
+    // to be the same bits on every level, a render node without FMA included. So no
+    // "fma" in these targets either, or the compiler could contract them itself.
+
+    static_assert(juce::dsp::SIMDRegister<float>::SIMDNumElements == 4
+                  && juce::dsp::SIMDRegister<double>::SIMDNumElements == 2, "the cascade kernels expect SSE registers");
+
+    inline __m128 loadLanes(const float* p)           { return _mm_loadu_ps(p); }
+    inline __m128d loadLanes(const double* p)         { return _mm_loadu_pd(p); }
+    inline void storeLanes(float* p, __m128 v)        { _mm_storeu_ps(p, v); }
+    inline void storeLanes(double* p, __m128d v)      { _mm_storeu_pd(p, v); }
+    inline __m128 multiply(__m128 a, __m128 b)        { return _mm_mul_ps(a, b); }
+    inline __m128d multiply(__m128d a, __m128d b)     { return _mm_mul_pd(a, b); }
+    inline __m128 add(__m128 a, __m128 b)             { return _mm_add_ps(a, b); }
+    inline __m128d add(__m128d a, __m128d b)          { return _mm_add_pd(a, b); }
+    inline __m128 subtract(__m128 a, __m128 b)        { return _mm_sub_ps(a, b); }
+    inline __m128d subtract(__m128d a, __m128d b)     { return _mm_sub_pd(a, b); }
+
+    // SIMDChain::snapToZero()
+    inline __m128 snapToZero(__m128 v)
+    {
+        auto magnitude = _mm_andnot_ps(_mm_set1_ps(-0.f), v);
+        return _mm_and_ps(v, _mm_cmpgt_ps(magnitude, _mm_set1_ps(1.0e-8f)));
+    }
+
+    inline __m128d snapToZero(__m128d v)
+    {
+        auto magnitude = _mm_andnot_pd(_mm_set1_pd(-0.0), v);
+        return _mm_and_pd(v, _mm_cmpgt_pd(magnitude, _mm_set1_pd(1.0e-8)));
+    }
+
+    // Same TDF2 as SIMDChain::runSection(), section after section on every sample.
+    template<typename SampleType, int NumSections>
+    JUCE_FORCEINLINE void runCascade(SampleType* data, int numSamples, const BiquadLanes<SampleType>* sections)
+    {
+        using Lanes = decltype(loadLanes(data));
+        constexpr int lanes = (int)(sizeof(Lanes) / sizeof(SampleType));
+
+        Lanes b0[NumSections], b1[NumSections], b2[NumSections], a1[NumSections], a2[NumSections],
+              s1[NumSections], s2[NumSections];
+
+        for (int k = 0; k < NumSections; ++k)
+        {
+            b0[k] = loadLanes(sections[k].b0); b1[k] = loadLanes(sections[k].b1); b2[k] = loadLanes(sections[k].b2);
+            a1[k] = loadLanes(sections[k].a1); a2[k] = loadLanes(sections[k].a2);
+            s1[k] = loadLanes(sections[k].s1); s2[k] = loadLanes(sections[k].s2);
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto* frame = data + i * lanes;
+            auto x = loadLanes(frame);
+
+            // Unrolled even at -O2, or the states go through the stack on every sample.
+            EELEQ_UNROLL
+            for (int k = 0; k < NumSections; ++k)
+            {
+                auto y = add(multiply(x, b0[k]), s1[k]);
+
+                s1[k] = add(subtract(multiply(x, b1[k]), multiply(y, a1[k])), s2[k]);
+                s2[k] = subtract(multiply(x, b2[k]), multiply(y, a2[k]));
+
+                x = y;
+            }
+
+            storeLanes(frame, x);
+        }
+
+        for (int k = 0; k < NumSections; ++k)
+        {
+            storeLanes(sections[k].s1, snapToZero(s1[k]));
+            storeLanes(sections[k].s2, snapToZero(s2[k]));
+        }
+    }
+   #endif
+
+    //==============================================================================
+    // The analyzer loops, force inlined into every level's wrappers for the compiler
+    // to vectorise (-O3) with what that level has. No branches and no float maths
+    // that's only needed on one side of a select: with trapping maths on GCC won't
+    // speculate it, and won't vectorise the loop. So the selects go through the bits.
+
+    JUCE_FORCEINLINE juce::uint32 toBits(float x)
+    {
+        juce::uint32 bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        return bits;
+    }
+
+    JUCE_FORCEINLINE float fromBits(juce::uint32 bits)
+    {
+        float x;
+        std::memcpy(&x, &bits, sizeof(x));
+        return x;
+    }
+
+    JUCE_FORCEINLINE float select(bool condition, float a, float b)
+    {
+        auto mask = (juce::uint32)0 - (juce::uint32)condition;
+        return fromBits((toBits(a) & mask) | (toBits(b) & ~mask));
+    }
+
+    // log10 without a libm call, within a few float ulps. Garbage for zero, denormals
+    // and negative numbers, the caller selects those away.
+    JUCE_FORCEINLINE float log10Approximation(float x)
+    {
+        auto bits = toBits(x);
+        auto exponent = (int)((bits >> 23) & 0xff) - 127;
+
+        // Mantissa into [sqrt(1/2), sqrt(2)) so the series below converges fast.
+        bits = (bits & 0x7fffff) | 0x3f800000;
+        auto upper = bits > 0x3fb504f3; // sqrt(2)
+        bits -= upper ? 0x800000u : 0u;
+        exponent += upper ? 1 : 0;
+
+        // ln(m) = 2 atanh((m - 1) / (m + 1))
+        auto mantissa = fromBits(bits);
+        auto t = (mantissa - 1.f) / (mantissa + 1.f);
+        auto t2 = t * t;
+        auto ln = 2.f * t * (1.f + t2 * (1.f / 3.f + t2 * (1.f / 5.f + t2 * (1.f / 7.f + t2 * (1.f / 9.f)))));
+
+        return (float)exponent * 0.30102999566f + ln * 0.43429448190f;
+    }
+
+    // FFTDataGenerator's normalisation and juce::Decibels::gainToDecibels() in one pass.
+    JUCE_FORCEINLINE void toDecibels(float* data, int numBins, float divisor, float negativeInfinity)
+    {
+        for (int i = 0; i < numBins; ++i)
+        {
+            auto v = data[i];
+
+            auto finite = (toBits(v) & 0x7f800000) != 0x7f800000; // not NaN or infinite
+            v = select(finite, v / divisor, 0.f);
+
+            auto decibels = 20.f * log10Approximation(v);
+            decibels = decibels > negativeInfinity ? decibels : negativeInfinity;
+
+            data[i] = select(v > 0.f, decibels, negativeInfinity);
+        }
+    }
+
+    JUCE_FORCEINLINE void multiplyBy(float* data, const float* factors, int numSamples)
+    {
+        for (int i = 0; i < numSamples; ++i)
+            data[i] *= factors[i];
+    }
+
+    template<typename SampleType>
+    using CascadeTable = std::array<CascadeKernel<SampleType>, MaxCascadeSections + 1>;
+
+    //==============================================================================
+    // One namespace per level, the same wrappers with a different target.
+
+    namespace baseline
+    {
+        void magnitudesToDecibels(float* data, int numBins, float divisor, float negativeInfinity)
+        {
+            toDecibels(data, numBins, divisor, negativeInfinity);
+        }
+
+        void multiply(float* data, const float* factors, int numSamples)
+        {
+            multiplyBy(data, factors, numSamples);
+        }
+    }
+
+   #if EELEQ_CPU_DISPATCH
+    namespace sse41
+    {
+        EELEQ_TARGET("sse4.1") void magnitudesToDecibels(float* data, int numBins, float divisor, float negativeInfinity)
+        {
+            toDecibels(data, numBins, divisor, negativeInfinity);
+        }
+
+        EELEQ_TARGET("sse4.1") void multiply(float* data, const float* factors, int numSamples)
+        {
+            multiplyBy(data, factors, numSamples);
+        }
+    }
+
+    namespace avx2
+    {
+        template<typename SampleType, int NumSections>
+        EELEQ_TARGET("avx2") void cascade(SampleType* data, int numSamples, const BiquadLanes<SampleType>* sections)
+        {
+            runCascade<SampleType, NumSections>(data, numSamples, sections);
+        }
+
+        // Nothing at index 0, the chain doesn't run without a section.
+        template<typename SampleType, size_t... NumSections>
+        CascadeTable<SampleType> makeCascades(std::index_sequence<NumSections...>)
+        {
+            return { { nullptr, &cascade<SampleType, (int)NumSections + 1>... } };
+        }
+
+        EELEQ_TARGET("avx2,fma") void magnitudesToDecibels(float* data, int numBins, float divisor, float negativeInfinity)
+        {
+            toDecibels(data, numBins, divisor, negativeInfinity);
+        }
+
+        EELEQ_TARGET("avx2,fma") void multiply(float* data, const float* factors, int numSamples)
+        {
+            multiplyBy(data, factors, numSamples);
+        }
+    }
+
+    // The cascades stay on AVX2's (a biquad's recursion doesn't get any shorter on
+    // wider registers, and there are at most 4 lanes to fill). The analyzer loops
+    // are written out on zmm registers, 16 bins at a time, the tail through a mask.
+    namespace avx512
+    {
+        EELEQ_TARGET("avx512f") inline __m512 toDecibels16(__m512 v, __m512 divisor, __m512 negativeInfinity)
+        {
+            auto exponentMask = _mm512_set1_epi32(0x7f800000);
+
+            // Same steps as toDecibels() and log10Approximation(), the selects as masks.
+            auto finite = _mm512_cmpneq_epi32_mask(_mm512_and_si512(_mm512_castps_si512(v), exponentMask), exponentMask);
+            v = _mm512_maskz_div_ps(finite, v, divisor);
+
+            auto bits = _mm512_castps_si512(v);
+            auto exponent = _mm512_sub_epi32(_mm512_and_si512(_mm512_srli_epi32(bits, 23), _mm512_set1_epi32(0xff)),
+                                             _mm512_set1_epi32(127));
+
+            bits = _mm512_or_si512(_mm512_and_si512(bits, _mm512_set1_epi32(0x7fffff)), _mm512_set1_epi32(0x3f800000));
+            auto upper = _mm512_cmpgt_epi32_mask(bits, _mm512_set1_epi32(0x3fb504f3));
+            bits = _mm512_mask_sub_epi32(bits, upper, bits, _mm512_set1_epi32(0x800000));
+            exponent = _mm512_mask_add_epi32(exponent, upper, exponent, _mm512_set1_epi32(1));
+
+            auto one = _mm512_set1_ps(1.f);
+            auto mantissa = _mm512_castsi512_ps(bits);
+            auto t = _mm512_div_ps(_mm512_sub_ps(mantissa, one), _mm512_add_ps(mantissa, one));
+            auto t2 = _mm512_mul_ps(t, t);
+
+            auto series = _mm512_add_ps(_mm512_set1_ps(1.f / 7.f), _mm512_mul_ps(t2, _mm512_set1_ps(1.f / 9.f)));
+            series = _mm512_add_ps(_mm512_set1_ps(1.f / 5.f), _mm512_mul_ps(t2, series));
+            series = _mm512_add_ps(_mm512_set1_ps(1.f / 3.f), _mm512_mul_ps(t2, series));
+            series = _mm512_add_ps(one, _mm512_mul_ps(t2, series));
+            auto ln = _mm512_mul_ps(_mm512_mul_ps(_mm512_set1_ps(2.f), t), series);
+
+            auto log10 = _mm512_add_ps(_mm512_mul_ps(_mm512_cvtepi32_ps(exponent), _mm512_set1_ps(0.30102999566f)),
+                                       _mm512_mul_ps(ln, _mm512_set1_ps(0.43429448190f)));
+
+            // max() hands back its second operand for a NaN, like the comparison in toDecibels().
+            auto decibels = _mm512_max_ps(_mm512_mul_ps(_mm512_set1_ps(20.f), log10), negativeInfinity);
+            auto positive = _mm512_cmp_ps_mask(v, _mm512_setzero_ps(), _CMP_GT_OQ);
+
+            return _mm512_mask_blend_ps(positive, negativeInfinity, decibels);
+        }
+
+        EELEQ_TARGET("avx512f") void magnitudesToDecibels(float* data, int numBins, float divisor, float negativeInfinity)
+        {
+            auto divisors = _mm512_set1_ps(divisor);
+            auto floor = _mm512_set1_ps(negativeInfinity);
+            int i = 0;
+
+            for (; i + 16 <= numBins; i += 16)
+                _mm512_storeu_ps(data + i, toDecibels16(_mm512_loadu_ps(data + i), divisors, floor));
+
+            if (i < numBins)
+            {
+                auto tail = (__mmask16)((1u << (numBins - i)) - 1u);
+                _mm512_mask_storeu_ps(data + i, tail, toDecibels16(_mm512_maskz_loadu_ps(tail, data + i), divisors, floor));
+            }
+        }
+
+        EELEQ_TARGET("avx512f") void multiply(float* data, const float* factors, int numSamples)
+        {
+            int i = 0;
+
+            for (; i + 16 <= numSamples; i += 16)
+                _mm512_storeu_ps(data + i, _mm512_mul_ps(_mm512_loadu_ps(data + i), _mm512_loadu_ps(factors + i)));
+
+            if (i < numSamples)
+            {
+                auto tail = (__mmask16)((1u << (numSamples - i)) - 1u);
+                _mm512_mask_storeu_ps(data + i, tail, _mm512_mul_ps(_mm512_maskz_loadu_ps(tail, data + i),
+                                                                    _mm512_maskz_loadu_ps(tail, factors + i)));
+            }
+        }
+    }
+   #endif
+
+    //==============================================================================
+
+    CpuKernels makeKernels(CpuLevel level)
+    {
+        CpuKernels kernels;
+        kernels.magnitudesToDecibels = &baseline::magnitudesToDecibels;
+        kernels.multiply = &baseline::multiply;
+
+       #if EELEQ_CPU_DISPATCH
+        constexpr auto sectionCounts = std::make_index_sequence<MaxCascadeSections>();
+
+        switch (level)
+        {
+            case CpuLevel_SSE41:
+                kernels.magnitudesToDecibels = &sse41::magnitudesToDecibels;
+                kernels.multiply = &sse41::multiply;
+                break;
+
+            case CpuLevel_AVX2:
+                kernels.floatCascades = avx2::makeCascades<float>(sectionCounts);
+                kernels.doubleCascades = avx2::makeCascades<double>(sectionCounts);
+                kernels.magnitudesToDecibels = &avx2::magnitudesToDecibels;
+                kernels.multiply = &avx2::multiply;
+                break;
+
+            case CpuLevel_AVX512:
+                kernels.floatCascades = avx2::makeCascades<float>(sectionCounts);
+                kernels.doubleCascades = avx2::makeCascades<double>(sectionCounts);
+                kernels.magnitudesToDecibels = &avx512::magnitudesToDecibels;
+                kernels.multiply = &avx512::multiply;
+                break;
+
+            case CpuLevel_Baseline:
+            case NumCpuLevels:
+                break;
+        }
+       #else
+        juce::ignoreUnused(level);
+       #endif
+
+        return kernels;
+    }
+
+    CpuLevel detectCpuLevel()
+    {
+       #if EELEQ_CPU_DISPATCH
+        if (juce::SystemStats::hasAVX512F() && juce::SystemStats::hasAVX2())
+            return CpuLevel_AVX512;
+
+        if (juce::SystemStats::hasAVX2())
+            return CpuLevel_AVX2;
+
+        if (juce::SystemStats::hasSSE41())
+            return CpuLevel_SSE41;
+       #endif
+
+        return CpuLevel_Baseline;
+    }
+
+    struct Dispatch
+    {
+        Dispatch()
+        {
+            for (int level = 0; level < NumCpuLevels; ++level)
+                kernels[(size_t)level] = makeKernels((CpuLevel)level);
+
+            auto level = detected;
+            auto forced = juce::SystemStats::getEnvironmentVariable("EELEQ_CPU", {});
+
+            // Logged, not DBG: a release build is where somebody would set this.
+            if (forced.isNotEmpty() && !parseCpuLevel(forced, level))
+                juce::Logger::writeToLog("EELEQ_CPU: unknown level \"" + forced + "\", using "
+                                         + getCpuLevelName(detected));
+
+            selected = juce::jmin(level, detected);
+        }
+
+        const CpuLevel detected = detectCpuLevel();
+        std::atomic<int> selected { CpuLevel_Baseline };
+        std::array<CpuKernels, NumCpuLevels> kernels;
+    };
+
+    Dispatch& getDispatch()
+    {
+        static Dispatch dispatch;
+        return dispatch;
+    }
+}
+
+//==============================================================================
+
+CpuLevel getDetectedCpuLevel()
+{
+    return getDispatch().detected;
+}
+
+CpuLevel getCpuLevel()
+{
+    return (CpuLevel)getDispatch().selected.load();
+}
+
+void setCpuLevel(CpuLevel level)
+{
+    auto& dispatch = getDispatch();
+
+    // Can't run what the CPU doesn't have.
+    jassert(level <= dispatch.detected);
+
+    dispatch.selected = juce::jmin(level, dispatch.detected);
+}
+
+juce::String getCpuLevelName(CpuLevel level)
+{
+    switch (level)
+    {
+        case CpuLevel_Baseline: return "baseline";
+        case CpuLevel_SSE41:    return "sse4.1";
+        case CpuLevel_AVX2:     return "avx2";
+        case CpuLevel_AVX512:   return "avx512";
+        case NumCpuLevels:      break;
+    }
+
+    return {};
+}
+
+bool parseCpuLevel(const juce::String& name, CpuLevel& level)
+{
+    for (int i = 0; i < NumCpuLevels; ++i)
+    {
+        if (name.trim().equalsIgnoreCase(getCpuLevelName((CpuLevel)i)))
+        {
+            level = (CpuLevel)i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const CpuKernels& getCpuKernels()
+{
+    auto& dispatch = getDispatch();
+    return dispatch.kernels[(size_t)dispatch.selected.load()];
+}
@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    CpuDispatch.h
+    Created: 18 Oct 2026 12:31:07am
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <type_traits>
+#include "BiquadDesign.h"
+
+//==============================================================================
+// Kernels compiled for several instruction sets, one picked at runtime.
+//
+// The baseline is whatever the build targets (SSE2 on x86-64, NEON on ARM), the
+// other levels are the same kernel bodies compiled again with GCC/Clang target
+// attributes, so one binary runs the best it can on an SSE4 render node and on an
+// AVX-512 workstation. The CPU is checked once (juce::SystemStats, i.e. CPUID),
+// users take their kernels in prepare() or wherever it's not the audio thread.
+//
+// The level can be forced lower for testing: EELEQ_CPU=baseline|sse4.1|avx2|avx512
+// in the environment, or setCpuLevel() from the tools. Never above what the CPU has.
+//
+// Null cascade kernels mean "no better than the SIMDRegister code", SIMDChain keeps
+// its own loops then. There's nothing in SSE4.1 for a biquad, so only the AVX2 and
+// AVX-512 levels have them (VEX encoded, states in registers for the whole block).
+// They don't fuse the multiply-adds: the chain's output is the same bits on every
+// level, so a render on one machine matches the plugin on another (EelEQVerify
+// checks). AVX-512 adds the analyzer loops on 512 bit registers.
+
+enum CpuLevel
+{
+    CpuLevel_Baseline,
+    CpuLevel_SSE41,
+    CpuLevel_AVX2,
+    CpuLevel_AVX512, // F
+    NumCpuLevels
+};
+
+CpuLevel getDetectedCpuLevel();
+
+// The one in use, the detected level unless it's been forced lower.
+CpuLevel getCpuLevel();
+
+// Not realtime safe to change under a running chain, it picks it up in its next prepare().
+void setCpuLevel(CpuLevel level);
+
+juce::String getCpuLevelName(CpuLevel level);
+
+// "baseline", "sse4.1", "avx2" or "avx512". Returns false for anything else.
+bool parseCpuLevel(const juce::String& name, CpuLevel& level);
+
+//==============================================================================
+
+// One biquad's coefficients and state, a value per SIMD lane
+// (SIMDRegister<SampleType>::SIMDNumElements of them, one lane per channel).
+template<typename SampleType>
+struct BiquadLanes
+{
+    const SampleType* b0;
+    const SampleType* b1;
+    const SampleType* b2;
+    const SampleType* a1;
+    const SampleType* a2;
+    SampleType* s1;
+    SampleType* s2;
+};
+
+// TDF2 sections one after the other on interleaved samples (lanes per frame),
+// states written back with the same denormal guard as IIR::Filter.
+template<typename SampleType>
+using CascadeKernel = void (*)(SampleType* data, int numSamples, const BiquadLanes<SampleType>* sections);
+
+constexpr int MaxCascadeSections = 2 * MaxCutSections + 1; // the fixed bands, LowCut -> Peak -> HighCut
+
+struct CpuKernels
+{
+    // By number of sections, null where SIMDChain's own loops are as good.
+    std::array<CascadeKernel<float>, MaxCascadeSections + 1> floatCascades {};
+    std::array<CascadeKernel<double>, MaxCascadeSections + 1> doubleCascades {};
+
+    // Analyzer: magnitudes / divisor to dB (non-finite ones count as silence),
+    // everything at or below negativeInfinity dB comes out as negativeInfinity.
+    void (*magnitudesToDecibels)(float* data, int numBins, float divisor, float negativeInfinity) = nullptr;
+
+    // data[i] *= factors[i], the FFT window.
+    void (*multiply)(float* data, const float* factors, int numSamples) = nullptr;
+
+    template<typename SampleType>
+    CascadeKernel<SampleType> getCascade(int numSections) const
+    {
+        jassert(numSections >= 0 && numSections <= MaxCascadeSections);
+
+        if constexpr (std::is_same<SampleType, float>::value)
+            return floatCascades[(size_t)numSections];
+        else
+            return doubleCascades[(size_t)numSections];
+    }
+};
+
+// The kernels of getCpuLevel().
+const CpuKernels& getCpuKernels();
@@ -0,0 +1,239 @@
+/*
+  ==============================================================================
+
+    DspProfiler.h
+    Created: 18 Oct 2026 2:07:44am
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+//==============================================================================
+// Audio thread timing, for profiling builds only: set EELEQ_PROFILING=1 in the
+// exporter's preprocessor definitions. Left at 0 none of this exists, the
+// EELEQ_PROFILE macros expand to nothing and there's no member to pay for.
+//
+// Every stage gets a histogram of how long it took per call, log2 buckets in
+// nanoseconds, counted with relaxed atomics so the audio thread never waits and
+// the editor (or a debugger) can read them whenever. Per instance, not global.
+//
+// The DSP load is the time processBlock took over the time the block lasts,
+// averaged and peaked over about a second of audio. A block over 100% is an
+// overrun: the host would have had to wait for it on a single core.
+
+#ifndef EELEQ_PROFILING
+ #define EELEQ_PROFILING 0
+#endif
+
+// The common case runs the fixed bands through one fused kernel (SIMDChain), that's
+// timed as FixedBands and LowCut / Peak / HighCut stay empty. EELEQ_PROFILING_PER_BAND=1
+// on top makes a profiled chain skip the fused kernel so those three fill up, at the
+// cost of not timing what ships.
+#ifndef EELEQ_PROFILING_PER_BAND
+ #define EELEQ_PROFILING_PER_BAND 0
+#endif
+
+#if EELEQ_PROFILING
+
+enum ProfilerStage
+{
+    ProfilerStage_Block,        // the whole processBlock
+    ProfilerStage_Parameters,   // taking the designer's latest set (and linear phase kernel)
+    ProfilerStage_Coefficients, // ramp / dynamic bell redesigns at control ticks
+    ProfilerStage_LowCut,       // these three only off the fused kernel, see EELEQ_PROFILING_PER_BAND
+    ProfilerStage_Peak,
+    ProfilerStage_HighCut,
+    ProfilerStage_FixedBands,   // the fused kernel, all three fixed bands in one pass
+    ProfilerStage_UserBands,
+    ProfilerStage_AnalyzerTap,  // StereoSampleFifo::update()
+    NumProfilerStages
+};
+
+inline const char* getProfilerStageName(ProfilerStage stage)
+{
+    static constexpr const char* names[] { "Block", "Parameters", "Coefficients", "LowCut", "Peak", "HighCut",
+                                           "FixedBands", "UserBands", "AnalyzerTap" };
+    static_assert(sizeof(names) / sizeof(names[0]) == NumProfilerStages, "one name per stage");
+
+    return names[stage];
+}
+
+struct DspProfiler
+{
+    // Bucket b counts the calls that took [2^b, 2^(b+1)) ns, the last one everything above ~2 s.
+    static constexpr int NumBuckets = 32;
+    using Histogram = std::array<juce::uint32, NumBuckets>;
+
+    DspProfiler() : nanosPerTick(1.0e9 / (double)juce::Time::getHighResolutionTicksPerSecond()) {}
+
+    // Not the audio thread. Keeps the histograms, only the load window starts over.
+    void prepare(double newSampleRate)
+    {
+        sampleRate = newSampleRate;
+        windowSamples = 0;
+        windowBusySeconds = 0.0;
+        windowPeakLoad = 0.0;
+    }
+
+    // Any thread, not realtime safe against a running block (counts may come out a call off).
+    void reset()
+    {
+        for (auto& histogram : histograms)
+            for (auto& count : histogram)
+                count.store(0, std::memory_order_relaxed);
+
+        numOverruns.store(0);
+        averageLoad.store(0.f);
+        peakLoad.store(0.f);
+    }
+
+    void record(ProfilerStage stage, juce::int64 ticks)
+    {
+        auto nanos = (juce::uint64)juce::jmax(0.0, (double)ticks * nanosPerTick);
+        int bucket = 0;
+
+        while ((nanos >>= 1) != 0 && bucket < NumBuckets - 1)
+            ++bucket;
+
+        histograms[stage][(size_t)bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Audio thread, once per host block with the whole block's time.
+    void finishBlock(juce::int64 ticks, int numSamples)
+    {
+        record(ProfilerStage_Block, ticks);
+
+        if (sampleRate <= 0.0 || numSamples <= 0)
+            return;
+
+        auto seconds = (double)ticks * nanosPerTick * 1.0e-9;
+        auto load = seconds * sampleRate / (double)numSamples;
+
+        if (load > 1.0)
+            numOverruns.fetch_add(1);
+
+        windowBusySeconds += seconds;
+        windowPeakLoad = juce::jmax(windowPeakLoad, load);
+        windowSamples += numSamples;
+
+        if (windowSamples >= sampleRate)
+        {
+            averageLoad.store((float)(windowBusySeconds * sampleRate / (double)windowSamples));
+            peakLoad.store((float)windowPeakLoad);
+
+            windowSamples = 0;
+            windowBusySeconds = 0.0;
+            windowPeakLoad = 0.0;
+        }
+    }
+
+    // Fractions of the buffer period (1 = 100%) over the last second or so.
+    float getAverageLoad() const { return averageLoad.load(); }
+    float getPeakLoad() const { return peakLoad.load(); }
+
+    // Blocks that took longer than they last, since the last reset().
+    juce::uint32 getNumOverruns() const { return numOverruns.load(); }
+
+    Histogram getHistogram(ProfilerStage stage) const
+    {
+        Histogram histogram;
+
+        for (size_t b = 0; b < (size_t)NumBuckets; ++b)
+            histogram[b] = histograms[stage][b].load(std::memory_order_relaxed);
+
+        return histogram;
+    }
+
+    // Upper edge of the bucket the given fraction of calls fall under, 0 with no calls yet.
+    double getPercentileNanos(ProfilerStage stage, double fraction) const
+    {
+        auto histogram = getHistogram(stage);
+        juce::uint64 total = 0;
+
+        for (auto count : histogram)
+            total += count;
+
+        if (total == 0)
+            return 0.0;
+
+        auto target = (juce::uint64)std::ceil(fraction * (double)total);
+        juce::uint64 sum = 0;
+
+        for (int b = 0; b < NumBuckets; ++b)
+        {
+            sum += histogram[(size_t)b];
+
+            if (sum >= target)
+                return std::ldexp(1.0, b + 1);
+        }
+
+        return std::ldexp(1.0, NumBuckets);
+    }
+
+    //==============================================================================
+    // Times its scope into one stage. A null profiler makes it a no-op.
+    struct ScopedTimer
+    {
+        ScopedTimer(DspProfiler* p, ProfilerStage s) :
+        profiler(p), stage(s), start(p != nullptr ? juce::Time::getHighResolutionTicks() : 0) {}
+
+        ~ScopedTimer()
+        {
+            if (profiler != nullptr)
+                profiler->record(stage, juce::Time::getHighResolutionTicks() - start);
+        }
+
+        DspProfiler* profiler;
+        ProfilerStage stage;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedTimer)
+    };
+
+    // The whole block, for the load.
+    struct ScopedBlock
+    {
+        ScopedBlock(DspProfiler& p, int samples) :
+        profiler(p), numSamples(samples), start(juce::Time::getHighResolutionTicks()) {}
+
+        ~ScopedBlock() { profiler.finishBlock(juce::Time::getHighResolutionTicks() - start, numSamples); }
+
+        DspProfiler& profiler;
+        int numSamples;
+        juce::int64 start;
+
+        JUCE_DECLARE_NON_COPYABLE(ScopedBlock)
+    };
+
+private:
+    using Counters = std::array<std::atomic<juce::uint32>, NumBuckets>;
+    std::array<Counters, NumProfilerStages> histograms {};
+
+    std::atomic<juce::uint32> numOverruns {0};
+    std::atomic<float> averageLoad {0.f}, peakLoad {0.f};
+
+    const double nanosPerTick;
+
+    // Audio thread only.
+    double sampleRate = 0.0;
+    double windowBusySeconds = 0.0, windowPeakLoad = 0.0;
+    int windowSamples = 0;
+
+    JUCE_DECLARE_NON_COPYABLE(DspProfiler)
+};
+
+ #define EELEQ_PROFILE(profiler, stage)             DspProfiler::ScopedTimer JUCE_JOIN_MACRO(profiledScope, __LINE__) (profiler, stage)
+ #define EELEQ_PROFILE_BLOCK(profiler, numSamples)  DspProfiler::ScopedBlock JUCE_JOIN_MACRO(profiledBlock, __LINE__) (profiler, numSamples)
+
+#else
+
+ #define EELEQ_PROFILE(profiler, stage)
+ #define EELEQ_PROFILE_BLOCK(profiler, numSamples)
+
+#endif
@@ -0,0 +1,154 @@
+/*
+  ==============================================================================
+
+    DynamicPeak.cpp
+    Created: 17 Oct 2026 7:14:05pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#include "DynamicPeak.h"
+
+//==============================================================================
+
+DynamicPeak::DynamicPeak(juce::AudioProcessorValueTreeState& apvts) :
+threshold(apvts.getRawParameterValue("Dynamic Threshold")),
+ratio(apvts.getRawParameterValue("Dynamic Ratio")),
+attack(apvts.getRawParameterValue("Dynamic Attack")),
+release(apvts.getRawParameterValue("Dynamic Release")),
+sidechain(apvts.getRawParameterValue("Dynamic Sidechain"))
+{
+    jassert(threshold != nullptr && ratio != nullptr && attack != nullptr
+            && release != nullptr && sidechain != nullptr);
+}
+
+void DynamicPeak::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+    detector.assign((size_t)juce::jmax(1, maximumBlockSize), 0.f);
+
+    // Redesign the band-pass for the new rate on the first block.
+    designedFrequency = designedQuality = 0.f;
+
+    reset();
+}
+
+void DynamicPeak::reset()
+{
+    s1 = s2 = 0.0;
+    pendingPeak = 0.f;
+    pendingSamples = 0;
+    envelope = 0.f;
+    blockLength = readPosition = 0;
+}
+
+bool DynamicPeak::usesSidechain() const
+{
+    return sidechain->load() > 0.5f;
+}
+
+//==============================================================================
+
+void DynamicPeak::addToDetector(const float* source, int numSamples, bool first)
+{
+    if (first)
+        juce::FloatVectorOperations::copy(detector.data(), source, numSamples);
+    else
+        juce::FloatVectorOperations::add(detector.data(), source, numSamples);
+}
+
+void DynamicPeak::addToDetector(const double* source, int numSamples, bool first)
+{
+    // The detector runs in float whatever the host precision, plain loops vectorise fine.
+    auto* d = detector.data();
+
+    if (first)
+        for (int i = 0; i < numSamples; ++i)
+            d[i] = (float)source[i];
+    else
+        for (int i = 0; i < numSamples; ++i)
+            d[i] += (float)source[i];
+}
+
+void DynamicPeak::setBandPass(float frequency, float quality)
+{
+    if (frequency == designedFrequency && quality == designedQuality)
+        return;
+
+    designedFrequency = frequency;
+    designedQuality = quality;
+
+    // RBJ band-pass with 0 dB at the centre, so the threshold reads like a level at the bell's frequency.
+    auto w0 = juce::MathConstants<double>::twoPi
+            * juce::jlimit(2.0, sampleRate * 0.49, (double)frequency) / sampleRate;
+    auto alpha = std::sin(w0) / (2.0 * juce::jmax(0.01, (double)quality));
+    auto a0 = 1.0 + alpha;
+
+    b0 = alpha / a0;
+    b2 = -alpha / a0;
+    a1 = -2.0 * std::cos(w0) / a0;
+    a2 = (1.0 - alpha) / a0;
+}
+
+void DynamicPeak::bandPass(int numSamples)
+{
+    auto* d = detector.data();
+
+    // b1 is zero for the band-pass.
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto input = (double)d[i];
+        auto output = b0 * input + s1;
+
+        s1 = -a1 * output + s2;
+        s2 = b2 * input - a2 * output;
+
+        d[i] = (float)output;
+    }
+
+    // Denormal guard, like the chain's sections.
+    if (std::abs(s1) < 1.0e-15) s1 = 0.0;
+    if (std::abs(s2) < 1.0e-15) s2 = 0.0;
+}
+
+void DynamicPeak::consume(int position)
+{
+    position = juce::jmin(position, blockLength);
+
+    if (position <= readPosition)
+        return;
+
+    auto range = juce::FloatVectorOperations::findMinAndMax(detector.data() + readPosition, position - readPosition);
+
+    pendingPeak = juce::jmax(pendingPeak, -range.getStart(), range.getEnd());
+    pendingSamples += position - readPosition;
+    readPosition = position;
+}
+
+float DynamicPeak::getGainInDecibels(int position, float peakGainInDecibels)
+{
+    consume(position);
+
+    // Attack/release over everything since the last tick, in one step.
+    if (pendingSamples > 0)
+    {
+        auto timeMs = pendingPeak > envelope ? attack->load() : release->load();
+        auto coefficient = (float)std::exp(-pendingSamples / (juce::jmax(0.01, (double)timeMs) * 0.001 * sampleRate));
+
+        envelope = pendingPeak + (envelope - pendingPeak) * coefficient;
+
+        pendingPeak = 0.f;
+        pendingSamples = 0;
+    }
+
+    auto over = juce::Decibels::gainToDecibels(envelope, -120.f) - threshold->load();
+
+    if (over <= 0.f)
+        return 0.f;
+
+    auto amount = over * (1.f - 1.f / juce::jmax(1.f, ratio->load()));
+    auto range = std::abs(peakGainInDecibels);
+
+    return std::copysign(juce::jmin(amount, range), peakGainInDecibels);
+}
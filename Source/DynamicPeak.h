@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    DynamicPeak.h
+    Created: 17 Oct 2026 7:14:05pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+// Detector and gain computer for the "Peak Dynamic" band.
+//
+// The key (the main input, or the sidechain bus with "Dynamic Sidechain" on) is
+// summed to mono and band-passed at the bell's frequency and Q, a whole host block
+// at a time. The envelope only moves at control rate: every tick the owner asks
+// for a new gain, the detector's peak since the last tick (a vectorised min/max)
+// goes through the attack/release follower and the gain computer, and the bell
+// gets redesigned once. Per sample that's a mono sum, one biquad and a min/max.
+//
+// Over the threshold the bell's gain moves from 0 dB towards "Peak Gain" by
+// (level - threshold) * (1 - 1 / ratio) dB, never past it. A negative "Peak Gain"
+// makes a downward band (de-essing, taming resonances), a positive one boosts.
+
+struct DynamicPeak
+{
+    explicit DynamicPeak(juce::AudioProcessorValueTreeState& apvts);
+
+    // Not realtime safe.
+    void prepare(double sampleRate, int maximumBlockSize);
+    void reset();
+
+    bool usesSidechain() const;
+
+    // Audio thread, once per host block before it's processed. frequency and quality are the bell's.
+    template<typename SampleType>
+    void pushKey(const juce::AudioBuffer<SampleType>& key, float frequency, float quality)
+    {
+        auto numSamples = juce::jmin(key.getNumSamples(), (int)detector.size());
+        auto numChannels = key.getNumChannels();
+        auto* d = detector.data();
+
+        if (numChannels == 0)
+        {
+            juce::FloatVectorOperations::clear(d, numSamples);
+        }
+        else
+        {
+            for (int ch = 0; ch < numChannels; ++ch)
+                addToDetector(key.getReadPointer(ch), numSamples, ch == 0);
+
+            if (numChannels > 1)
+                juce::FloatVectorOperations::multiply(d, 1.f / (float)numChannels, numSamples);
+        }
+
+        setBandPass(frequency, quality);
+        bandPass(numSamples);
+
+        blockLength = numSamples;
+        readPosition = 0;
+    }
+
+    // Audio thread, at a control tick 'position' samples into the current block.
+    // Returns the bell's gain for this tick, within 0 dB and peakGainInDecibels.
+    float getGainInDecibels(int position, float peakGainInDecibels);
+
+    // Audio thread, end of the host block. The rest of the block counts towards the next tick.
+    void finishBlock() { consume(blockLength); }
+
+private:
+    std::atomic<float>* threshold;
+    std::atomic<float>* ratio;
+    std::atomic<float>* attack;
+    std::atomic<float>* release;
+    std::atomic<float>* sidechain;
+
+    double sampleRate = 44100.0;
+
+    std::vector<float> detector; // one host block of band-passed key
+    int blockLength = 0, readPosition = 0;
+
+    // Band-pass, double state (the bell goes down to 20 Hz at 192 kHz).
+    float designedFrequency = 0.f, designedQuality = 0.f;
+    double b0 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+    double s1 = 0.0, s2 = 0.0;
+
+    float pendingPeak = 0.f; // since the last tick
+    int pendingSamples = 0;
+    float envelope = 0.f;
+
+    void addToDetector(const float* source, int numSamples, bool first);
+    void addToDetector(const double* source, int numSamples, bool first);
+
+    void setBandPass(float frequency, float quality);
+    void bandPass(int numSamples);
+    void consume(int position);
+
+    JUCE_DECLARE_NON_COPYABLE(DynamicPeak)
+};
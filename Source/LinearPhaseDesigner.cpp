@@ -0,0 +1,173 @@
+/*
+  ==============================================================================
+
+    LinearPhaseDesigner.cpp
+    Created: 17 Oct 2026 3:58:14pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseDesigner.h"
+#include "ChainOversampler.h"
+
+//==============================================================================
+
+namespace
+{
+    // The first set's bands, the kernel is built from those.
+    juce::StringArray getKernelParameterIDs()
+    {
+        auto ids = getChainParameterIDs(0);
+        ids.add("Phase Mode");
+        ids.add("Partition Size");
+        return ids;
+    }
+}
+
+LinearPhaseDesigner::LinearPhaseDesigner(juce::AudioProcessorValueTreeState& apvts) :
+snapshot(apvts),
+phaseMode(apvts.getRawParameterValue("Phase Mode")),
+partitionSizeChoice(apvts.getRawParameterValue("Partition Size")),
+watcher(apvts, getKernelParameterIDs(), *thread, *this)
+{
+    jassert(phaseMode != nullptr && partitionSizeChoice != nullptr);
+
+    thread->addTimeSliceClient(this);
+}
+
+LinearPhaseDesigner::~LinearPhaseDesigner()
+{
+    thread->removeTimeSliceClient(this);
+}
+
+void LinearPhaseDesigner::prepare(double newSampleRate)
+{
+    const juce::ScopedLock sl(designLock);
+
+    sampleRate = newSampleRate;
+
+    // New rate, new kernel.
+    designedVersions.fill(0);
+    designedUserBandsVersion = 0;
+    designedPartitionSize = 0;
+
+    // Ready before the first block if the mode is already on.
+    if (isActive() && needsRedesign())
+        designKernel();
+}
+
+bool LinearPhaseDesigner::isActive() const
+{
+    return phaseMode->load() > 0.5f;
+}
+
+int LinearPhaseDesigner::useTimeSlice()
+{
+    const juce::ScopedLock sl(designLock);
+
+    // Cleared either way, so turning the mode on wakes us. needsRedesign() goes by the values.
+    watcher.takeChanges();
+
+    // Nothing to do in minimum phase mode (or before prepare).
+    if (sampleRate <= 0.0 || !isActive())
+        return idleIntervalMs;
+
+    if (needsRedesign())
+        designKernel();
+
+    return watcher.hasChanges() ? pollIntervalMs : idleIntervalMs;
+}
+
+bool LinearPhaseDesigner::needsRedesign()
+{
+    snapshot.update();
+
+    bool changed = designedPartitionSize != getPartitionSize(juce::roundToInt(partitionSizeChoice->load()));
+
+    for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+    {
+        if (designedVersions[band] != snapshot.getVersion(band))
+        {
+            designedVersions[band] = snapshot.getVersion(band);
+            changed = true;
+        }
+    }
+
+    if (designedUserBandsVersion != snapshot.getUserBandsVersion())
+    {
+        designedUserBandsVersion = snapshot.getUserBandsVersion();
+        changed = true;
+    }
+
+    return changed;
+}
+
+void LinearPhaseDesigner::designKernel()
+{
+    const auto& chainSettings = snapshot.getSettings();
+    auto partitionSize = getPartitionSize(juce::roundToInt(partitionSizeChoice->load()));
+    designedPartitionSize = partitionSize;
+
+    constexpr auto length = LinearPhaseKernelLength;
+
+    // Same coefficients (and oversampled design rate) as the minimum phase path and the curve on screen.
+    auto chainCoefficients = makeChainCoefficients(chainSettings,
+                                                   sampleRate * getOversamplingFactor(chainSettings.oversamplingOrder));
+
+    if (kernelFFT == nullptr)
+    {
+        kernelFFT = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(length)));
+        impulse.resize((size_t)(2 * length));
+    }
+
+    // Magnitude on the FFT grid, the (-1)^k is a delay of length / 2 samples.
+    auto* bins = reinterpret_cast<std::complex<float>*>(impulse.data());
+
+    for (int k = 0; k <= length / 2; ++k)
+    {
+        auto frequency = (double)k * sampleRate / (double)length;
+        auto magnitude = (float)getChainMagnitudeForFrequency(chainCoefficients, frequency);
+
+        bins[k] = { (k & 1) ? -magnitude : magnitude, 0.f };
+    }
+
+    kernelFFT->performRealOnlyInverseTransform(impulse.data());
+
+    // Blackman window centred on the peak at length / 2, keeps the time aliasing of
+    // the sampled response out of the kernel's tails.
+    for (int n = 0; n < length; ++n)
+    {
+        auto phase = juce::MathConstants<double>::twoPi * n / length;
+        impulse[(size_t)n] *= (float)(0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase));
+    }
+
+    // Cut into partitions, each zero padded to 2 * partitionSize and transformed.
+    auto partitionOrder = juce::roundToInt(std::log2(2 * partitionSize));
+
+    if (partitionFFT == nullptr || partitionFFT->getSize() != 2 * partitionSize)
+    {
+        partitionFFT = std::make_unique<juce::dsp::FFT>(partitionOrder);
+        partitionBuffer.resize((size_t)(4 * partitionSize));
+    }
+
+    auto& kernel = kernelBuffer.getWriteBuffer();
+    auto numBins = partitionSize + 1;
+
+    kernel.partitionSize = partitionSize;
+    kernel.numPartitions = length / partitionSize;
+    kernel.spectra.resize((size_t)(kernel.numPartitions * numBins)); // worker thread, allowed to allocate
+
+    for (int p = 0; p < kernel.numPartitions; ++p)
+    {
+        std::fill(partitionBuffer.begin(), partitionBuffer.end(), 0.f);
+        std::copy(impulse.begin() + p * partitionSize, impulse.begin() + (p + 1) * partitionSize, partitionBuffer.begin());
+
+        partitionFFT->performRealOnlyForwardTransform(partitionBuffer.data(), true);
+
+        auto* spectrum = reinterpret_cast<const std::complex<float>*>(partitionBuffer.data());
+        std::copy(spectrum, spectrum + numBins, kernel.spectra.begin() + p * numBins);
+    }
+
+    kernelBuffer.publish();
+}
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    LinearPhaseDesigner.h
+    Created: 17 Oct 2026 3:58:14pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <memory>
+#include <vector>
+#include "ChainSettings.h"
+#include "BiquadDesign.h"
+#include "CoefficientDesigner.h"
+#include "PartitionedConvolver.h"
+#include "TripleBuffer.h"
+
+//==============================================================================
+// Builds the "Linear Phase" kernel off the audio thread.
+//
+// While the mode is on it wakes up on the shared DesignerThread when a parameter
+// moves (ParameterWatcher, like CoefficientDesigner) and samples the chain's magnitude (the response curve,
+// designed at the same rate the minimum phase chain would run at) on a
+// LinearPhaseKernelLength point grid, gives it a pure delay of half the kernel,
+// windows the impulse and cuts it into partition spectra for the convolver.
+// The result is handed over through a TripleBuffer like the biquad coefficients.
+
+struct LinearPhaseDesigner : juce::TimeSliceClient
+{
+    explicit LinearPhaseDesigner(juce::AudioProcessorValueTreeState& apvts);
+    ~LinearPhaseDesigner() override;
+
+    // Message thread, audio stopped. sampleRate is the host rate.
+    void prepare(double sampleRate);
+
+    // Audio thread.
+    bool pullLatest() { return kernelBuffer.acquire(); }
+    const PartitionedKernel& getLatest() const { return kernelBuffer.getReadBuffer(); }
+
+    int useTimeSlice() override;
+
+private:
+    juce::SharedResourcePointer<DesignerThread> thread;
+
+    ChainSettingsSnapshot snapshot;
+    std::atomic<float>* phaseMode;
+    std::atomic<float>* partitionSizeChoice;
+
+    std::array<juce::uint32, NumChainPositions> designedVersions {};
+    juce::uint32 designedUserBandsVersion = 0;
+    int designedPartitionSize = 0;
+
+    TripleBuffer<PartitionedKernel> kernelBuffer;
+
+    std::unique_ptr<juce::dsp::FFT> kernelFFT, partitionFFT;
+    std::vector<float> impulse, partitionBuffer;
+
+    juce::CriticalSection designLock; // designer thread vs prepare()
+    double sampleRate = 0.0;
+
+    ParameterWatcher watcher;
+
+    static constexpr int pollIntervalMs = 5;   // while the parameters keep moving
+    static constexpr int idleIntervalMs = 500; // in case a listener call slipped past
+
+    bool isActive() const;
+
+    // Caller holds designLock.
+    bool needsRedesign();
+    void designKernel();
+
+    JUCE_DECLARE_NON_COPYABLE(LinearPhaseDesigner)
+};
@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    ParameterSmoothing.cpp
+    Created: 16 Oct 2026 5:21:09pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#include "ParameterSmoothing.h"
+
+//==============================================================================
+
+void ChainSmoother::reset(double sampleRate, double rampLengthSeconds)
+{
+    lowCutFreq.reset(sampleRate, rampLengthSeconds);
+    highCutFreq.reset(sampleRate, rampLengthSeconds);
+    peakFreq.reset(sampleRate, rampLengthSeconds);
+    peakQuality.reset(sampleRate, rampLengthSeconds);
+    peakGain.reset(sampleRate, rampLengthSeconds);
+}
+
+void ChainSmoother::setCurrentAndTarget(const ChainSettings& chainSettings)
+{
+    lowCutFreq.setCurrentAndTargetValue(chainSettings.lowCutFreq);
+    highCutFreq.setCurrentAndTargetValue(chainSettings.highCutFreq);
+    peakFreq.setCurrentAndTargetValue(chainSettings.peakFreq);
+    peakQuality.setCurrentAndTargetValue(chainSettings.peakQuality);
+    peakGain.setCurrentAndTargetValue(chainSettings.peakGainInDecibels);
+}
+
+void ChainSmoother::setTarget(const ChainSettings& chainSettings)
+{
+    lowCutFreq.setTargetValue(chainSettings.lowCutFreq);
+    highCutFreq.setTargetValue(chainSettings.highCutFreq);
+    peakFreq.setTargetValue(chainSettings.peakFreq);
+    peakQuality.setTargetValue(chainSettings.peakQuality);
+    peakGain.setTargetValue(chainSettings.peakGainInDecibels);
+}
+
+bool ChainSmoother::isSmoothing() const
+{
+    return isSmoothing(ChainPositions::LowCut)
+        || isSmoothing(ChainPositions::Peak)
+        || isSmoothing(ChainPositions::HighCut);
+}
+
+bool ChainSmoother::isSmoothing(ChainPositions band) const
+{
+    switch (band)
+    {
+        case ChainPositions::LowCut:  return lowCutFreq.isSmoothing();
+        case ChainPositions::Peak:    return peakFreq.isSmoothing() || peakQuality.isSmoothing() || peakGain.isSmoothing();
+        case ChainPositions::HighCut: return highCutFreq.isSmoothing();
+    }
+
+    return false;
+}
+
+void ChainSmoother::skip(int numSamples)
+{
+    lowCutFreq.skip(numSamples);
+    highCutFreq.skip(numSamples);
+    peakFreq.skip(numSamples);
+    peakQuality.skip(numSamples);
+    peakGain.skip(numSamples);
+}
+
+ChainSettings ChainSmoother::getCurrentSettings(const ChainSettings& target) const
+{
+    auto current = target;
+
+    current.lowCutFreq = lowCutFreq.getCurrentValue();
+    current.highCutFreq = highCutFreq.getCurrentValue();
+    current.peakFreq = peakFreq.getCurrentValue();
+    current.peakQuality = peakQuality.getCurrentValue();
+    current.peakGainInDecibels = peakGain.getCurrentValue();
+
+    return current;
+}
+
+//==============================================================================
+
+juce::StringArray getControlRateChoices()
+{
+    return { "16 Samples", "32 Samples", "64 Samples", "128 Samples" };
+}
+
+int getControlRateInSamples(int choiceIndex)
+{
+    // 16 << index
+    return 16 << juce::jlimit(0, 3, choiceIndex);
+}
@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    ParameterSmoothing.h
+    Created: 16 Oct 2026 5:21:09pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+
+//==============================================================================
+// Ramps for the continuous chain parameters.
+//
+// Frequencies and Q ramp multiplicatively (straight lines on the log axis the
+// response curve uses), gain ramps linearly in dB. The owner redesigns the moving
+// bands from these values at control rate, so every intermediate filter is a
+// real, stable design instead of a lerp between two sets of biquad coefficients.
+
+struct ChainSmoother
+{
+    void reset(double sampleRate, double rampLengthSeconds);
+
+    // Jump straight to these values (prepareToPlay).
+    void setCurrentAndTarget(const ChainSettings& chainSettings);
+    void setTarget(const ChainSettings& chainSettings);
+
+    bool isSmoothing() const;
+    bool isSmoothing(ChainPositions band) const;
+
+    void skip(int numSamples);
+
+    // The smoothed continuous values, with the discrete ones (slopes, bypasses) taken from 'target'.
+    ChainSettings getCurrentSettings(const ChainSettings& target) const;
+
+private:
+    using MultiplicativeValue = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>;
+    using LinearValue = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>;
+
+    MultiplicativeValue lowCutFreq, highCutFreq, peakFreq, peakQuality;
+    LinearValue peakGain;
+};
+
+//==============================================================================
+// "Control Rate" choices, in samples between coefficient updates while ramping.
+
+juce::StringArray getControlRateChoices();
+int getControlRateInSamples(int choiceIndex);
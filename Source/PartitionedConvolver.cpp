@@ -0,0 +1,215 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.cpp
+    Created: 17 Oct 2026 3:26:40pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#include "PartitionedConvolver.h"
+
+//==============================================================================
+
+juce::StringArray getPartitionSizeChoices()
+{
+    return { "256", "512", "1024", "2048" };
+}
+
+int getPartitionSize(int choiceIndex)
+{
+    // 256 << index
+    return 256 << juce::jlimit(0, NumPartitionSizes - 1, choiceIndex);
+}
+
+//==============================================================================
+
+void PartitionedConvolver::prepare(int numChannels, double newSampleRate)
+{
+    sampleRate = newSampleRate;
+
+    auto smallest = getPartitionSize(0);
+    auto largest = getPartitionSize(NumPartitionSizes - 1);
+
+    // partitions * bins = kernelLength / size * (size + 1), largest for the smallest partition size.
+    auto maxSpectraSize = (size_t)(LinearPhaseKernelLength / smallest * (smallest + 1));
+    auto maxBins = (size_t)(largest + 1);
+
+    channels.resize((size_t)juce::jmax(1, numChannels));
+
+    for (auto& channel : channels)
+    {
+        channel.input.assign((size_t)(2 * largest), 0.f);
+        channel.output.assign((size_t)largest, 0.f);
+        channel.delayLine.assign(maxSpectraSize, {});
+    }
+
+    kernel.assign(maxSpectraSize, {});
+    nextKernel.assign(maxSpectraSize, {});
+    accumulator.assign(maxBins, {});
+    nextAccumulator.assign(maxBins, {});
+
+    // juce::dsp::FFT's real transforms want twice the FFT size (= 4 * partition size) to work in.
+    fftBuffer.assign((size_t)(4 * largest), 0.f);
+    nextFftBuffer.assign((size_t)(4 * largest), 0.f);
+
+    for (int i = 0; i < NumPartitionSizes; ++i)
+        ffts[(size_t)i] = std::make_unique<juce::dsp::FFT>(juce::roundToInt(std::log2(2 * getPartitionSize(i))));
+
+    // No kernel until the designer delivers one.
+    partitionSize = numPartitions = numBins = 0;
+    fft = nullptr;
+
+    reset();
+}
+
+void PartitionedConvolver::reset()
+{
+    for (auto& channel : channels)
+    {
+        std::fill(channel.input.begin(), channel.input.end(), 0.f);
+        std::fill(channel.output.begin(), channel.output.end(), 0.f);
+        std::fill(channel.delayLine.begin(), channel.delayLine.end(), Complex {});
+    }
+
+    position = 0;
+    delayLineHead = 0;
+
+    // Nothing to fade from.
+    if (crossfadeBlocksLeft > 0)
+        std::swap(kernel, nextKernel);
+
+    crossfadeBlocksLeft = 0;
+}
+
+void PartitionedConvolver::setLayout(int newPartitionSize)
+{
+    partitionSize = newPartitionSize;
+    numPartitions = LinearPhaseKernelLength / partitionSize;
+    numBins = partitionSize + 1;
+
+    for (int i = 0; i < NumPartitionSizes; ++i)
+        if (getPartitionSize(i) == partitionSize)
+            fft = ffts[(size_t)i].get();
+
+    // ~20 ms of crossfade, whole partitions.
+    crossfadeBlocks = juce::jmax(1, juce::roundToInt(0.02 * sampleRate / partitionSize));
+}
+
+void PartitionedConvolver::copyKernel(const PartitionedKernel& source, std::vector<Complex>& destination)
+{
+    auto size = (size_t)(source.numPartitions * (source.partitionSize + 1));
+
+    jassert(source.spectra.size() >= size && destination.size() >= size);
+
+    std::copy(source.spectra.begin(), source.spectra.begin() + (std::ptrdiff_t)size, destination.begin());
+}
+
+void PartitionedConvolver::setKernel(const PartitionedKernel& newKernel)
+{
+    jassert(newKernel.numPartitions * newKernel.partitionSize == LinearPhaseKernelLength);
+
+    if (newKernel.partitionSize != partitionSize)
+    {
+        setLayout(newKernel.partitionSize);
+        reset();
+        copyKernel(newKernel, kernel);
+        return;
+    }
+
+    // Still fading to the previous one? Land on it first, the owner retries next block.
+    if (isCrossfading())
+    {
+        jassertfalse;
+        return;
+    }
+
+    copyKernel(newKernel, nextKernel);
+    crossfadeBlocksLeft = crossfadeBlocks;
+}
+
+//==============================================================================
+
+void PartitionedConvolver::convolve(const Channel& channel, const std::vector<Complex>& kernelSpectra,
+                                    std::vector<Complex>& sum, std::vector<float>& timeDomain)
+{
+    std::fill(sum.begin(), sum.begin() + numBins, Complex {});
+
+    // Partition p of the kernel meets the input from p partitions ago.
+    for (int p = 0; p < numPartitions; ++p)
+    {
+        auto slot = delayLineHead - p;
+
+        if (slot < 0)
+            slot += numPartitions;
+
+        auto* x = reinterpret_cast<const float*>(channel.delayLine.data() + slot * numBins);
+        auto* h = reinterpret_cast<const float*>(kernelSpectra.data() + p * numBins);
+        auto* y = reinterpret_cast<float*>(sum.data());
+
+        // Plain float maths so it vectorises, std::complex's operator* doesn't.
+        for (int k = 0; k < numBins; ++k)
+        {
+            auto xr = x[2 * k], xi = x[2 * k + 1];
+            auto hr = h[2 * k], hi = h[2 * k + 1];
+
+            y[2 * k]     += xr * hr - xi * hi;
+            y[2 * k + 1] += xr * hi + xi * hr;
+        }
+    }
+
+    std::copy(sum.begin(), sum.begin() + numBins, reinterpret_cast<Complex*>(timeDomain.data()));
+    fft->performRealOnlyInverseTransform(timeDomain.data());
+}
+
+void PartitionedConvolver::processPartition(int numActiveChannels)
+{
+    auto crossfading = isCrossfading();
+
+    for (int ch = 0; ch < numActiveChannels; ++ch)
+    {
+        auto& channel = channels[(size_t)ch];
+
+        // Spectrum of the last two partitions of input into the delay line.
+        std::copy(channel.input.begin(), channel.input.begin() + 2 * partitionSize, fftBuffer.begin());
+        fft->performRealOnlyForwardTransform(fftBuffer.data(), true);
+
+        std::copy(reinterpret_cast<const Complex*>(fftBuffer.data()),
+                  reinterpret_cast<const Complex*>(fftBuffer.data()) + numBins,
+                  channel.delayLine.begin() + delayLineHead * numBins);
+
+        convolve(channel, kernel, accumulator, fftBuffer);
+
+        // Overlap-save: only the second half is free of circular wrap-around.
+        auto* result = fftBuffer.data() + partitionSize;
+
+        if (crossfading)
+        {
+            convolve(channel, nextKernel, nextAccumulator, nextFftBuffer);
+
+            auto* nextResult = nextFftBuffer.data() + partitionSize;
+            auto fadeLength = (float)(crossfadeBlocks * partitionSize);
+            auto fadeStart = (float)((crossfadeBlocks - crossfadeBlocksLeft) * partitionSize);
+
+            for (int i = 0; i < partitionSize; ++i)
+            {
+                auto gain = (fadeStart + (float)i) / fadeLength;
+                channel.output[(size_t)i] = result[i] + gain * (nextResult[i] - result[i]);
+            }
+        }
+        else
+        {
+            std::copy(result, result + partitionSize, channel.output.begin());
+        }
+
+        // Slide the overlap-save window by one partition.
+        std::copy(channel.input.begin() + partitionSize, channel.input.begin() + 2 * partitionSize, channel.input.begin());
+    }
+
+    if (++delayLineHead == numPartitions)
+        delayLineHead = 0;
+
+    if (crossfading && --crossfadeBlocksLeft == 0)
+        std::swap(kernel, nextKernel);
+}
@@ -0,0 +1,136 @@
+/*
+  ==============================================================================
+
+    PartitionedConvolver.h
+    Created: 17 Oct 2026 3:26:40pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <complex>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+// Linear phase mode: kernel length and the "Partition Size" choices.
+// Latency = kernel length / 2 (the symmetric FIR's centre) + one partition.
+
+constexpr int LinearPhaseKernelLength = 16384;
+
+constexpr int NumPartitionSizes = 4;
+
+juce::StringArray getPartitionSizeChoices();
+int getPartitionSize(int choiceIndex);
+
+//==============================================================================
+// A kernel already cut into partitions and transformed: numPartitions spectra of
+// partitionSize + 1 bins each (FFT size 2 * partitionSize), partition 0 first.
+
+struct PartitionedKernel
+{
+    int partitionSize = 0;
+    int numPartitions = 0;
+    std::vector<std::complex<float>> spectra;
+};
+
+//==============================================================================
+// Uniformly partitioned overlap-save convolution, the same kernel on every channel.
+//
+// Every partitionSize samples each channel's last two partitions of input get one
+// forward FFT into a frequency domain delay line, that's multiplied with the kernel
+// spectra and summed, and one inverse FFT gives the next partitionSize output samples.
+//
+// setKernel() copies a new kernel into storage sized in prepare(), so the audio
+// thread never allocates. Same partition size: the old and new kernels run side by
+// side for a few partitions and get crossfaded. New partition size: the engine is
+// re-laid out in place and starts from silence (the latency changes anyway).
+
+struct PartitionedConvolver
+{
+    // Not realtime safe. Allocates for the largest layout any partition size needs.
+    void prepare(int numChannels, double sampleRate);
+    void reset();
+
+    // Audio thread.
+    void setKernel(const PartitionedKernel& kernel);
+    bool hasKernel() const { return partitionSize > 0; }
+    bool isCrossfading() const { return crossfadeBlocksLeft > 0; }
+
+    int getLatencyInSamples() const { return LinearPhaseKernelLength / 2 + partitionSize; }
+
+    // Any block size, the partitioning is handled internally.
+    template<typename SampleType>
+    void process(const juce::dsp::AudioBlock<SampleType>& block)
+    {
+        jassert(hasKernel());
+
+        auto numBlockChannels = juce::jmin((int)block.getNumChannels(), (int)channels.size());
+        auto numSamples = (int)block.getNumSamples();
+
+        for (int done = 0; done < numSamples;)
+        {
+            auto length = juce::jmin(partitionSize - position, numSamples - done);
+
+            for (int ch = 0; ch < numBlockChannels; ++ch)
+            {
+                auto* data = block.getChannelPointer((size_t)ch) + done;
+                auto& channel = channels[(size_t)ch];
+
+                // The newest partition goes into the second half of the overlap-save buffer.
+                auto* input = channel.input.data() + partitionSize + position;
+                auto* output = channel.output.data() + position;
+
+                for (int i = 0; i < length; ++i)
+                {
+                    input[i] = static_cast<float>(data[i]);
+                    data[i] = static_cast<SampleType>(output[i]);
+                }
+            }
+
+            position += length;
+            done += length;
+
+            if (position == partitionSize)
+            {
+                processPartition(numBlockChannels);
+                position = 0;
+            }
+        }
+    }
+
+private:
+    using Complex = std::complex<float>;
+
+    struct Channel
+    {
+        std::vector<float> input;     // 2 * partitionSize, overlap-save window
+        std::vector<float> output;    // partitionSize, read while the next partition fills
+        std::vector<Complex> delayLine; // numPartitions spectra of past input
+    };
+
+    std::vector<Channel> channels;
+
+    std::vector<Complex> kernel, nextKernel;
+    std::vector<Complex> accumulator, nextAccumulator;
+    std::vector<float> fftBuffer, nextFftBuffer;
+
+    std::array<std::unique_ptr<juce::dsp::FFT>, NumPartitionSizes> ffts;
+    juce::dsp::FFT* fft = nullptr;
+
+    double sampleRate = 44100.0;
+    int partitionSize = 0, numPartitions = 0, numBins = 0;
+    int position = 0, delayLineHead = 0;
+    int crossfadeBlocks = 1, crossfadeBlocksLeft = 0;
+
+    void setLayout(int newPartitionSize);
+    void copyKernel(const PartitionedKernel& source, std::vector<Complex>& destination);
+
+    void processPartition(int numActiveChannels);
+    void convolve(const Channel& channel, const std::vector<Complex>& kernelSpectra,
+                  std::vector<Complex>& sum, std::vector<float>& timeDomain);
+};
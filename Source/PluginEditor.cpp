@@ -289,8 +289,7 @@ juce::String RotarySliderWithLabels::getDisplayString() const
 
 ResponseCurveComponent::ResponseCurveComponent(EelEQAudioProcessor& p):
 audioProcessor(p),
-leftPathProducer(audioProcessor.leftChannelFifo),
-rightPathProducer(audioProcessor.rightChannelFifo)
+pathProducer(audioProcessor.analyzerFifo, audioProcessor.apvts)
 {
     // Add listener
     const auto& params = audioProcessor.getParameters();
@@ -301,6 +300,7 @@ rightPathProducer(audioProcessor.rightChannelFifo)
     }
     
     //Paint the current parameters.
+    prepareBiquads(monoChain);
     UpdateChain();
     
     // start the timer (very importante)
@@ -337,7 +337,7 @@ void ResponseCurveComponent::updateResponseCurve()
     auto& highcut = monoChain.get<ChainPositions::HighCut>();
     
     
-    auto sampleRate = audioProcessor.getSampleRate();
+    auto sampleRate = chainSampleRate;
     
     std::vector<double> mags;
     
@@ -389,6 +389,13 @@ void ResponseCurveComponent::updateResponseCurve()
             }
         }
         
+        //user bands
+        for (int band = 0; band < curveCoefficients.settings.numUserBands; ++band)
+        {
+            if (isUserBandActive(curveCoefficients.settings, band))
+                mag *= curveCoefficients.userBands[(size_t)band].getMagnitudeForFrequency(freq, sampleRate);
+        }
+        
         mags[i] = Decibels::gainToDecibels(mag);
         
     }
@@ -436,17 +443,17 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
     
     if(shouldShowFFTAnalysis)
     {
-        //LEFT
-        auto leftChannelFFTPath = leftPathProducer.getPath();
-        leftChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
-        g.setColour(Colours::blue);
-        g.strokePath(leftChannelFFTPath, PathStrokeType(1.f));
-        
-        //RIGHT
-        auto rightChannelFFTPath = rightPathProducer.getPath();
-        rightChannelFFTPath.applyTransform(AffineTransform().translation(responseArea.getX(), responseArea.getY()));
-        g.setColour(Colours::red);
-        g.strokePath(rightChannelFFTPath, PathStrokeType(1.f));
+        auto toResponseArea = AffineTransform().translation(responseArea.getX(), responseArea.getY());
+        const auto& analyzerPaths = pathProducer.getPaths();
+        auto leftRight = analyzerPaths.view == AnalyzerView_LeftRight;
+        
+        //LEFT (or MID, or the SUM)
+        g.setColour(leftRight ? Colours::blue : Colours::cyan);
+        g.strokePath(analyzerPaths.first, PathStrokeType(1.f), toResponseArea);
+        
+        //RIGHT (or SIDE)
+        g.setColour(leftRight ? Colours::red : Colours::magenta);
+        g.strokePath(analyzerPaths.second, PathStrokeType(1.f), toResponseArea);
     }
     
     //Drawing the Response Curve Path
@@ -468,6 +475,18 @@ void ResponseCurveComponent::paint (juce::Graphics& g)
     //Text Labels aux funtion...
     drawTextLabels(g);
     
+    g.setColour(Colours::lightgrey);
+    g.setFont(10);
+    
+   #if EELEQ_PROFILING
+    // Design activity top left, the DSP load top right. Profiling builds only.
+    g.drawText(designsText, getAnalysisArea().reduced(4).removeFromTop(12), Justification::topLeft);
+    g.drawText(dspLoadText, getAnalysisArea().reduced(4).removeFromTop(12), Justification::topRight);
+   #endif
+    
+    // Linear phase running a split "Channel Mode" as Stereo, top centre.
+    g.drawText(channelModeText, getAnalysisArea().reduced(4).removeFromTop(12), Justification::centredTop);
+    
     //Orange Rectangle...
     g.setColour(Colours::orange);
     g.drawRoundedRectangle(getRenderArea().toFloat(), 4.f, 1.f);
@@ -661,55 +680,157 @@ void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float new
     
 }
 
-void PathProducer::process(juce::Rectangle<float> fftBounds, double sampleRate)
+PathProducer::PathProducer(StereoSampleFifo& fifo, juce::AudioProcessorValueTreeState& apvts) :
+analyzerFifo(&fifo),
+overlapParameter(apvts.getRawParameterValue("Analyzer Overlap")),
+sizeParameter(apvts.getRawParameterValue("Analyzer Size")),
+viewParameter(apvts.getRawParameterValue("Analyzer View"))
+{
+    changeOrder(getAnalyzerOrder());
+    
+    // Last, the worker may start on it straight away.
+    thread->addTimeSliceClient(this);
+}
+
+PathProducer::~PathProducer()
+{
+    // Blocks until a running useTimeSlice() has finished.
+    thread->removeTimeSliceClient(this);
+}
+
+void PathProducer::setRenderBounds(juce::Rectangle<float> fftBounds, double sampleRate)
+{
+    const juce::SpinLock::ScopedLockType sl(boundsLock);
+    
+    renderBounds = fftBounds;
+    renderSampleRate = sampleRate;
+}
+
+FFTOrder PathProducer::getAnalyzerOrder() const
 {
-    juce::AudioBuffer<float> tempIncomingBuffer;
+    // "Analyzer Size": 2048, 4096, 8192 or 16384.
+    return static_cast<FFTOrder>(FFTOrder::order2048 + juce::jlimit(0, 3, juce::roundToInt(sizeParameter->load())));
+}
+
+void PathProducer::changeOrder(FFTOrder newOrder)
+{
+    fftDataGenerator.changeOrder(newOrder);
+    auto fftSize = fftDataGenerator.getFFTSize();
+    
+    // The new window starts with the newest samples of the old one, so a bigger
+    // size doesn't drop the spectrum to silence while it fills up.
+    juce::AudioBuffer<float> window(2, fftSize);
+    window.clear();
+    
+    auto numToKeep = juce::jmin(fftSize, stereoBuffer.getNumSamples());
+    
+    if (numToKeep > 0)
+        for (int ch = 0; ch < 2; ++ch)
+            window.copyFrom(ch, fftSize - numToKeep, stereoBuffer, ch, stereoBuffer.getNumSamples() - numToKeep, numToKeep);
+    
+    stereoBuffer = std::move(window);
+    pulledBuffer.setSize(2, fftSize);
+    fftData.assign((size_t)fftSize * 2, 0.f);
+}
+
+int PathProducer::useTimeSlice()
+{
+    // The frames of the last slice are all gone, nothing of the old size is left in flight.
+    if (getAnalyzerOrder() != fftDataGenerator.getOrder())
+        changeOrder(getAnalyzerOrder());
+    
+    // "Analyzer Overlap": 2x, 4x or 8x.
+    auto fftSize = fftDataGenerator.getFFTSize();
+    auto hopSize = fftSize / (2 << juce::jlimit(0, 2, juce::roundToInt(overlapParameter->load())));
+    
+    // "Analyzer View", the same for every frame of this slice and the paths made from them.
+    auto view = static_cast<AnalyzerView>(juce::jlimit(0, 2, juce::roundToInt(viewParameter->load())));
+    
+    auto windowSize = stereoBuffer.getNumSamples();
+    auto numPulled = 0;
     
-    while(leftChannelFifo -> getNumCompleteBuffersAvailable() > 0)
     {
+        // prepareToPlay() waits on this before it empties the ring, so only the
+        // ring work goes in here. The FFTs and paths run on what we copied out.
+        const juce::ScopedLock sl(analyzerFifo->getReaderLock());
+        
+        if (!analyzerFifo->isPrepared())
+            return pollIntervalMs;
         
-        if (leftChannelFifo->getAudioBuffer(tempIncomingBuffer))
+        // Switched off: keep the ring empty so it's current when it comes back on.
+        if (!active.load())
         {
-            //Vamos a recorrer el buffer el numero de samples que estan en el buffer temporal
-            auto size = tempIncomingBuffer.getNumSamples();
-            
-            // copiamos el buffer y lo recorremos #size samples a la izquierda
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0,0),
-                                              monoBuffer.getReadPointer(0,size),
-                                              monoBuffer.getNumSamples() - size );
-            
-            juce::FloatVectorOperations::copy(monoBuffer.getWritePointer(0, monoBuffer.getNumSamples() - size),
-                                              tempIncomingBuffer.getReadPointer(0, 0),
-                                              size);
-      
-            leftChannelFFTDataGenerator.produceFFTDataForRendering(monoBuffer, -48.f);
-            
-            // -48 represents the -infinity. also is the bottom of the display...
-
+            analyzerFifo->skip(analyzerFifo->getNumSamplesAvailable());
+            return pollIntervalMs;
         }
+        
+        // More than a window behind (we were stalled): the older hops would never
+        // make it to the screen anyway, keep the last window's worth.
+        auto excess = analyzerFifo->getNumSamplesAvailable() - windowSize;
+        
+        if (excess > 0)
+            analyzerFifo->skip(excess);
+        
+        while (numPulled + hopSize <= windowSize
+               && analyzerFifo->getNumSamplesAvailable() >= hopSize
+               && analyzerFifo->pull(pulledBuffer.getWritePointer(Channel::Right, numPulled),
+                                     pulledBuffer.getWritePointer(Channel::Left, numPulled), hopSize))
+            numPulled += hopSize;
     }
     
-    
-    auto fftSize = leftChannelFFTDataGenerator.getFFTSize();
-    
-    const auto binWidth = sampleRate / double(fftSize);
-    
-    while (leftChannelFFTDataGenerator.getNumAvailableFFTDataBlocks() > 0)
+    for (int offset = 0; offset < numPulled; offset += hopSize)
     {
-        std::vector<float> fftData;
-        if(leftChannelFFTDataGenerator.getFFTData(fftData))
+        // recorremos el buffer #hopSize samples a la izquierda y copiamos el hop al final
+        for (int ch = 0; ch < 2; ++ch)
         {
-            pathProducer.generatePath(fftData, fftBounds, fftSize, binWidth, -48.f);
+            juce::FloatVectorOperations::copy(stereoBuffer.getWritePointer(ch, 0),
+                                              stereoBuffer.getReadPointer(ch, hopSize),
+                                              windowSize - hopSize );
+            
+            juce::FloatVectorOperations::copy(stereoBuffer.getWritePointer(ch, windowSize - hopSize),
+                                              pulledBuffer.getReadPointer(ch, offset),
+                                              hopSize);
         }
+        
+        fftDataGenerator.produceFFTDataForRendering(stereoBuffer, view, -48.f);
+        
+        // -48 represents the -infinity. also is the bottom of the display...
     }
     
-    //Actualizar los paths y utilizar los más recientes...
+    // Only the newest frame gets drawn.
+    auto newFrame = false;
+    
+    while (fftDataGenerator.getNumAvailableFFTDataBlocks() > 0)
+        newFrame = fftDataGenerator.getFFTData(fftData) || newFrame;
+    
+    juce::Rectangle<float> fftBounds;
+    double sampleRate;
     
-    while (pathProducer.getNumPathsAvailable() > 0)
     {
-        pathProducer.getPath(leftChannelFFTPath);
+        const juce::SpinLock::ScopedLockType sl(boundsLock);
+        fftBounds = renderBounds;
+        sampleRate = renderSampleRate;
     }
     
+    if (!newFrame || fftBounds.isEmpty() || sampleRate <= 0.0)
+        return pollIntervalMs;
+    
+    const auto binWidth = sampleRate / double(fftSize);
+    
+    //Actualizar los paths, los dos espectros del frame van uno detrás del otro...
+    auto& latest = paths.getWriteBuffer();
+    
+    pathGenerator.generatePath(latest.first, fftData.data(), fftBounds, fftSize, binWidth, -48.f);
+    
+    if (view == AnalyzerView_Sum)
+        latest.second.clear();
+    else
+        pathGenerator.generatePath(latest.second, fftData.data() + fftSize / 2, fftBounds, fftSize, binWidth, -48.f);
+    
+    latest.view = view;
+    paths.publish();
+    
+    return pollIntervalMs;
 }
 
 
@@ -717,15 +838,36 @@ void ResponseCurveComponent::timerCallback()
 {
     
     // Bypasseamos el proceso de la FFT aquí....
+    // (The analysis itself runs on the AnalyzerThread, here we only pick up its paths.)
     if(shouldShowFFTAnalysis)
     {
         auto fftBounds = getAnalysisArea().toFloat();
         auto sampleRate = audioProcessor.getSampleRate();
         
-        leftPathProducer.process(fftBounds, sampleRate);
-        rightPathProducer.process(fftBounds, sampleRate);
+        pathProducer.setRenderBounds(fftBounds, sampleRate);
+        pathProducer.pullPaths();
+    }
+    
+    // The "Ch2" controls do nothing while this is up.
+    channelModeText = audioProcessor.isChannelModeOverridden() ? "Linear phase: Channel Mode runs as Stereo" : "";
+    
+   #if EELEQ_PROFILING
+    // Design activity of the processor, should sit at 0 while nothing moves.
+    auto designsPerSecond = audioProcessor.getDesignsPerSecond();
+    if (designsPerSecond != lastDesignsPerSecond)
+    {
+        designsText = "Designs/s: " + juce::String(juce::roundToInt(designsPerSecond));
+        lastDesignsPerSecond = designsPerSecond;
     }
     
+    const auto& profiler = audioProcessor.getProfiler();
+    
+    dspLoadText = "DSP " + juce::String(profiler.getAverageLoad() * 100.f, 1) + "%"
+                + " (peak " + juce::String(profiler.getPeakLoad() * 100.f, 1) + "%), "
+                + juce::String(profiler.getNumOverruns()) + " over"
+                + (EELEQ_PROFILING_PER_BAND ? ", per band" : ", bands fused");
+   #endif
+    
     // Solo va a actualizar si se realizó algun cambio en el parametro
     if(parametersChanged.compareAndSetBool(false, true))
     {
@@ -743,21 +885,14 @@ void ResponseCurveComponent::timerCallback()
 void ResponseCurveComponent::UpdateChain()
 {
     
+    // Same designs (and the same apply code) the processor uses.
     auto chainSettings = getChainSettings(audioProcessor.apvts);
     
-    monoChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-    monoChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
-    monoChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-    
-    auto peakCoefficients = makePeakFilter(chainSettings, audioProcessor.getSampleRate());
-    UpdateCoefficients(monoChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    
-    auto lowcutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-    auto highcutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
-    
-    UpdateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowcutCoefficients, chainSettings.lowCutSlope);
-    UpdateCutFilter(monoChain.get<ChainPositions::HighCut>(), highcutCoefficients, chainSettings.highCutSlope);
+    // Oversampled, the filters run (and get designed) at a multiple of the host rate.
+    chainSampleRate = audioProcessor.getSampleRate() * getOversamplingFactor(chainSettings.oversamplingOrder);
     
+    curveCoefficients = makeChainCoefficients(chainSettings, chainSampleRate);
+    UpdateChainCoefficients(monoChain, curveCoefficients);
     
 }
 
@@ -10,6 +10,8 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "CpuDispatch.h"
+#include "TripleBuffer.h"
 
 //==============================================================================
 
@@ -20,61 +22,78 @@ enum FFTOrder
     
     order2048 = 11,
     order4096 = 12,
-    order8192 = 13
+    order8192 = 13,
+    order16384 = 14
     
 };
 
+// What the two analyzer curves are. All three come out of the same transform.
+enum AnalyzerView
+{
+    AnalyzerView_LeftRight,
+    AnalyzerView_MidSide,
+    AnalyzerView_Sum // one curve, L+R
+};
+
 template<typename BlockType>
 struct FFTDataGenerator
 {
     
-    //Produces the FFT data from an AudioBuffer
-    
-    void produceFFTDataForRendering (const juce::AudioBuffer<float>& audioData, const float negativeInfinity)
+    //Produces the FFT data from a stereo AudioBuffer (channels in Channel order, as StereoSampleFifo has them)
+    //
+    // Both channels go through one complex FFT, left as the real part and right as the
+    // imaginary part. They're real signals, so conjugate symmetry pulls them apart again:
+    //   L[k] = (X[k] + conj(X[N-k])) / 2      R[k] = (X[k] - conj(X[N-k])) / 2j
+    // Mid/Side and the sum are just those added up per bin.
+    //
+    // A frame is two spectra of numBins, one after the other: L then R, M then S, or the
+    // sum then nothing (all negativeInfinity).
+    
+    void produceFFTDataForRendering (const juce::AudioBuffer<float>& audioData, AnalyzerView view, const float negativeInfinity)
     {
         
         const auto fftSize = getFFTSize();
+        const int numBins = fftSize / 2;
         
-        fftData.assign(fftData.size(),0);
-        auto* readIndex = audioData.getReadPointer(0);
-        std::copy(readIndex, readIndex + fftSize, fftData.begin());
+        auto* left = audioData.getReadPointer(Channel::Left);
+        auto* right = audioData.getReadPointer(Channel::Right);
         
-        //first apply a windowing fucntion to our data.
-        window->multiplyWithWindowingTable(fftData.data(), fftSize);
+        for (int i = 0; i < fftSize; ++i)
+            fftInput[(size_t)i] = { left[i], right[i] };
+        
+        // Window, FFT, then normalise and convert to dB, with the kernels this CPU does best.
+        const auto& kernels = getCpuKernels();
+
+        //first apply a windowing fucntion to our data (the table has every value twice, real and imaginary).
+        kernels.multiply(reinterpret_cast<float*>(fftInput.data()), window.data(), fftSize * 2);
         
         // Render the FFT data...
-        forwardFFT->performFrequencyOnlyForwardTransform(fftData.data());
+        forwardFFT->perform(fftInput.data(), fftOutput.data(), false);
         
-        int numBins = (int)fftSize/2;
+        auto* first = fftData.data();
+        auto* second = fftData.data() + numBins;
+        const auto mask = (size_t)fftSize - 1;
         
-        //normalize the FFT values...
-        for (int i = 0; i < numBins; ++i)
+        for (int k = 0; k < numBins; ++k)
         {
-            auto v = fftData[i];
-
+            auto x = fftOutput[(size_t)k];
+            auto mirrored = std::conj(fftOutput[(size_t)(fftSize - k) & mask]);
             
-            if(!std::isinf(v) && !std::isnan(v))
-            {
-                
-                v /= float(numBins);
-                
-            }
-            else
+            auto l = (x + mirrored) * 0.5f;
+            auto r = (x - mirrored) * Complex(0.f, -0.5f);
+            
+            switch (view)
             {
-                v = 0.f;
+                case AnalyzerView_MidSide: first[k] = magnitude((l + r) * 0.5f); second[k] = magnitude((l - r) * 0.5f); break;
+                case AnalyzerView_Sum:     first[k] = magnitude(l + r);          second[k] = 0.f;                        break;
+                case AnalyzerView_LeftRight:
+                default:                   first[k] = magnitude(l);              second[k] = magnitude(r);               break;
             }
-            
-            fftData[i] = v;
-            
-        }
-    
-        //Convert them into decibels...
-        for (int i = 0; i < numBins; ++i)
-        {
-            
-            fftData[i] = juce::Decibels::gainToDecibels(fftData[i], negativeInfinity);
         }
         
+        //normalize the FFT values and convert them into decibels...
+        kernels.magnitudesToDecibels(fftData.data(), numBins * 2, float(numBins), negativeInfinity);
+        
         fftDataFifo.push(fftData);
         
     }
@@ -90,8 +109,18 @@ struct FFTDataGenerator
         auto fftSize = getFFTSize();
         
         forwardFFT = std::make_unique<juce::dsp::FFT>(order);
-        window = std::make_unique<juce::dsp::WindowingFunction<float>>(fftSize,
-                                                                       juce::dsp::WindowingFunction<float>::blackmanHarris);
+        
+        std::vector<float> table((size_t)fftSize);
+        juce::dsp::WindowingFunction<float>::fillWindowingTables(table.data(), (size_t)fftSize,
+                                                                 juce::dsp::WindowingFunction<float>::blackmanHarris);
+        
+        window.resize((size_t)fftSize * 2);
+        
+        for (size_t i = 0; i < table.size(); ++i)
+            window[2 * i] = window[2 * i + 1] = table[i];
+        
+        fftInput.assign((size_t)fftSize, {});
+        fftOutput.assign((size_t)fftSize, {});
         
         fftData.clear();
         fftData.resize(fftSize * 2, 0);
@@ -103,6 +132,7 @@ struct FFTDataGenerator
     //==============================================================================
     
     int getFFTSize() const { return 1 << order;}
+    FFTOrder getOrder() const { return order; }
     int getNumAvailableFFTDataBlocks() const { return fftDataFifo.getNumAvailableForReading();}
     
     //==============================================================================
@@ -110,10 +140,15 @@ struct FFTDataGenerator
     bool getFFTData(BlockType& fftData){return fftDataFifo.pull(fftData);}
     
 private:
+    using Complex = juce::dsp::Complex<float>;
+    
+    static float magnitude(Complex z) { return std::sqrt(std::norm(z)); }
+    
     FFTOrder order;
     BlockType fftData;
     std::unique_ptr<juce::dsp::FFT> forwardFFT;
-    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    std::vector<float> window; // the table, applied by CpuKernels::multiply
+    std::vector<Complex> fftInput, fftOutput;
     
     Fifo<BlockType> fftDataFifo;
 };
@@ -126,9 +161,10 @@ struct AnalyzerPathGenerator
 {
     
     /*
-     converts "renderData[]" into a juce::Path
+     converts "renderData[]" (fftSize/2 bins) into p
      */
-    void generatePath(const std::vector<float>& renderData,
+    void generatePath(PathType& p,
+                      const float* renderData,
                       juce::Rectangle<float> fftBounds,
                       int fftSize,
                       float binWidth,
@@ -141,8 +177,7 @@ struct AnalyzerPathGenerator
         
         int numBins = (int)fftSize/2;
         
-        PathType p;
-        
+        p.clear();
         p.preallocateSpace(3 * (int)fftBounds.getWidth());
         
         auto map = [bottom, top, negativeInfinity](float v)
@@ -162,9 +197,13 @@ struct AnalyzerPathGenerator
         
         p.startNewSubPath(0, y);
         
-        const int pathResolution = 2; //you can draw line-to's every pathResolution pixels.
+        // One point per pixel whatever the FFT size: the bins that land on the same
+        // pixel (most of them up top, and more the bigger the FFT) give the loudest one.
+        bool pixelStarted = false;
+        int pixelX = 0;
+        float pixelY = 0.f;
         
-        for( int binNum = 1; binNum < numBins; binNum += pathResolution)
+        for( int binNum = 1; binNum < numBins; ++binNum)
         {
             y = map(renderData[binNum]);
             
@@ -175,32 +214,26 @@ struct AnalyzerPathGenerator
                 auto binFreq = binNum * binWidth;
                 auto normalizedBinX = juce::mapFromLog10(binFreq, 20.f, 20000.f);
                 int binX = std::floor(normalizedBinX * width);
-                p.lineTo(binX,y);
                 
+                if (pixelStarted && binX == pixelX)
+                {
+                    pixelY = juce::jmin(pixelY, y); // up is louder
+                    continue;
+                }
+                
+                if (pixelStarted)
+                    p.lineTo(pixelX, pixelY);
+                
+                pixelStarted = true;
+                pixelX = binX;
+                pixelY = y;
             }
         }
         
-        pathFifo.push(p);
+        if (pixelStarted)
+            p.lineTo(pixelX, pixelY);
         
     }
-        
-    
-    int getNumPathsAvailable() const
-    {
-        
-        return pathFifo.getNumAvailableForReading();
-        
-    }
-    
-    bool getPath(PathType& path)
-    {
-        return pathFifo.pull(path);
-        
-    }
-    
-private:
-    
-    Fifo<PathType> pathFifo;
     
 };
 
@@ -277,28 +310,84 @@ private:
 };
 
 //==============================================================================
+// One background thread for the analyzers of every EelEQ editor that's open.
 
-struct PathProducer
+struct AnalyzerThread : juce::TimeSliceThread
 {
-    
-    PathProducer(SingleChannelSampleFifo<EelEQAudioProcessor::BlockType>& scsf) :
-    leftChannelFifo(&scsf)
+    AnalyzerThread() : juce::TimeSliceThread("EelEQ Analyzer")
     {
-        leftChannelFFTDataGenerator.changeOrder(FFTOrder::order4096);
-        monoBuffer.setSize(1, leftChannelFFTDataGenerator.getFFTSize());
-                
+        startThread();
+    }
+
+    ~AnalyzerThread() override
+    {
+        stopThread(1000);
     }
+};
+
+//==============================================================================
+// Spectrum of the front pair, worked out on the AnalyzerThread.
+//
+// Every hop (the FFT size over "Analyzer Overlap", whatever the host block size)
+// the window moves along and gets transformed, and the newest frame is turned
+// into paths for the last bounds the UI asked for. Paths go to the UI through a
+// TripleBuffer, so the message thread only picks up the latest and draws it.
+//
+// "Analyzer Size" is picked up between slices, and everything sized by it (FFT,
+// window table, frame fifo, the window of samples) only ever belongs to the worker,
+// so changing it mid-stream has nothing to race with. Same for "Analyzer View".
+
+struct AnalyzerPaths
+{
+    juce::Path first, second; // Left and Right, Mid and Side, or the sum and nothing
+    AnalyzerView view = AnalyzerView_LeftRight;
+};
+
+struct PathProducer : juce::TimeSliceClient
+{
+    PathProducer(StereoSampleFifo& fifo, juce::AudioProcessorValueTreeState& apvts);
+    ~PathProducer() override;
+    
+    // Message thread: where (and at which rate) the next paths should be drawn for.
+    // While it's not active the samples are thrown away unanalysed.
+    void setRenderBounds(juce::Rectangle<float> fftBounds, double sampleRate);
+    void setActive(bool shouldBeActive) { active.store(shouldBeActive); }
+    
+    // Message thread. True if newer paths came in, getPaths() is those until the next call.
+    bool pullPaths() { return paths.acquire(); }
+    const AnalyzerPaths& getPaths() const { return paths.getReadBuffer(); }
     
-    void process(juce::Rectangle<float> fftBounds, double sampleRate);
-    juce::Path getPath(){ return leftChannelFFTPath; }
+    int useTimeSlice() override;
     
 private:
+    juce::SharedResourcePointer<AnalyzerThread> thread;
     
-    SingleChannelSampleFifo<EelEQAudioProcessor::BlockType>* leftChannelFifo;
-    juce::AudioBuffer<float> monoBuffer;
-    FFTDataGenerator<std::vector<float>> leftChannelFFTDataGenerator;
-    AnalyzerPathGenerator<juce::Path> pathProducer;
-    juce::Path leftChannelFFTPath;
+    StereoSampleFifo* analyzerFifo;
+    std::atomic<float>* overlapParameter;
+    std::atomic<float>* sizeParameter;
+    std::atomic<float>* viewParameter;
+    std::atomic<bool> active {true};
+    
+    juce::SpinLock boundsLock; // message thread vs worker, never the audio thread
+    juce::Rectangle<float> renderBounds;
+    double renderSampleRate = 0.0;
+    
+    // Worker side.
+    juce::AudioBuffer<float> stereoBuffer; // the window, channels in Channel order
+    juce::AudioBuffer<float> pulledBuffer; // this slice's hops, copied out under the reader lock
+    FFTDataGenerator<std::vector<float>> fftDataGenerator;
+    AnalyzerPathGenerator<juce::Path> pathGenerator;
+    std::vector<float> fftData;
+    
+    TripleBuffer<AnalyzerPaths> paths;
+    
+    FFTOrder getAnalyzerOrder() const;
+    
+    // Worker (or constructor). Allocates.
+    void changeOrder(FFTOrder newOrder);
+    
+    // Sleep between slices, the UI doesn't repaint any faster than this anyway.
+    static constexpr int pollIntervalMs = 10;
 
 };
 
@@ -329,6 +418,7 @@ juce::Timer
     void toggleAnalysisEnablement(bool enabled)
     {
         shouldShowFFTAnalysis = enabled;
+        pathProducer.setActive(enabled);
         
     }
     
@@ -338,6 +428,16 @@ private:
     
     //Atomic Timer
     juce::Atomic<bool> parametersChanged {false};
+    juce::String channelModeText; // empty unless linear phase overrides "Channel Mode"
+    
+   #if EELEQ_PROFILING
+    float lastDesignsPerSecond = -1.f;
+    juce::String designsText; // "Designs/s: 0", drawn in the corner of the curve
+    
+    // "DSP 12.3% (peak 20.1%), 0 over, bands fused", drawn in the corner of the curve.
+    // "bands fused": the fixed bands only show up as FixedBands, not one by one.
+    juce::String dspLoadText;
+   #endif
 
     
     //BG IMAGE
@@ -357,10 +457,12 @@ private:
     
     //MonoChain
     MonoChain monoChain;
+    double chainSampleRate = 44100.0; // host rate x oversampling factor, what monoChain was designed at
+    ChainCoefficients curveCoefficients; // monoChain's set, the user bands are drawn straight from it
     void UpdateChain();
     
     //FFT
-    PathProducer leftPathProducer, rightPathProducer;
+    PathProducer pathProducer;
     
     //FFT Bypass condition
     bool shouldShowFFTAnalysis = true;
@@ -16,6 +16,7 @@ EelEQAudioProcessor::EelEQAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
@@ -63,7 +64,8 @@ bool EelEQAudioProcessor::isMidiEffect() const
 
 double EelEQAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // Follows the current design, see updateTailLength().
+    return tailLengthSeconds.load();
 }
 
 int EelEQAudioProcessor::getNumPrograms()
@@ -99,17 +101,112 @@ void EelEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
     juce::dsp::ProcessSpec spec;
     
     spec.maximumBlockSize = samplesPerBlock;
-    spec.numChannels = 1;
+    spec.numChannels = getMainBusNumInputChannels(); // the sidechain only feeds the detector
     spec.sampleRate = sampleRate;
     
-    leftChain.prepare(spec);
-    rightChain.prepare(spec);
+    // Every channel gets its own SIMD lane in the same cascade, the state is allocated here.
+    // Hosts pick the precision before prepareToPlay, so only that chain needs state.
+    // The chain's scratch is sized for the highest oversampling factor, the oversamplers
+    // for every factor are built now too so switching never allocates.
+    auto chainSpec = spec;
+    chainSpec.maximumBlockSize = spec.maximumBlockSize * (juce::uint32)getOversamplingFactor(MaxOversamplingOrder);
+    
+    if (isUsingDoublePrecision())
+    {
+        doubleChain.prepare(chainSpec);
+        doubleOversampler.prepare((int)spec.numChannels, samplesPerBlock);
+    }
+    else
+    {
+        floatChain.prepare(chainSpec);
+        floatOversampler.prepare((int)spec.numChannels, samplesPerBlock);
+    }
+    
+    // The bypass delay covers the longest latency any mode can have.
+    auto maxLatency = LinearPhaseKernelLength / 2 + getPartitionSize(NumPartitionSizes - 1);
+    
+    for (int order = 0; order <= MaxOversamplingOrder; ++order)
+        maxLatency = juce::jmax(maxLatency, isUsingDoublePrecision() ? doubleOversampler.getLatencyInSamples(order)
+                                                                     : floatOversampler.getLatencyInSamples(order));
+    
+    if (isUsingDoublePrecision())
+        doubleBypass.prepare((int)spec.numChannels, samplesPerBlock, maxLatency);
+    else
+        floatBypass.prepare((int)spec.numChannels, samplesPerBlock, maxLatency);
+    
+    updateCrossfadeLengths();
+    
+    dynamicPeak.prepare(sampleRate, samplesPerBlock);
+    blockPosition = 0;
+    
+    // The lanes of a split "Channel Mode" are set up before any coefficients go in.
+    channelMode = getChannelModeForLayout();
+    
+    if (isUsingDoublePrecision())
+        doubleChain.setChannelMode(channelMode);
+    else
+        floatChain.setChannelMode(channelMode);
+    
+    // Design for the new sample rate right here, the audio thread isn't running yet.
+    designCounter.prepare(sampleRate);
+    samplesUntilControlTick = 0;
+    
+    for (auto& channelSet : channelSets)
+    {
+        // A set that sits out isn't designed again until it's used.
+        channelSet.designer.setEnabled(channelSet.index < getNumActiveChannelSets());
+        channelSet.designer.prepare(sampleRate);
+        
+        // Start exactly on the designed values, no ramp after a (re)prepare.
+        channelSet.smoother.reset(sampleRate, smoothingTimeSeconds);
+        channelSet.bandRamping.fill(false);
+        
+        if (channelSet.designer.pullLatest())
+        {
+            const auto& chainCoefficients = channelSet.designer.getLatest();
+            
+            channelSet.smoother.setCurrentAndTarget(chainCoefficients.settings);
+            channelSet.tailSeconds = getChainTailInSeconds(chainCoefficients);
+            
+            if (channelSet.index < getNumActiveChannelSets())
+                setChainCoefficients(chainCoefficients, channelSet.index);
+            
+            setOversamplingOrder(chainCoefficients.settings.oversamplingOrder);
+        }
+    }
     
-    UpdateFilters();
+    // Linear phase engine, sized for every partition size. The kernel is built right away if the mode is on.
+    convolver.prepare((int)spec.numChannels, sampleRate);
+    linearPhaseDesigner.prepare(sampleRate);
+    
+    if (linearPhaseDesigner.pullLatest())
+        convolver.setKernel(linearPhaseDesigner.getLatest());
+    
+    linearPhaseActive = phaseModeParameter->load() > 0.5f && convolver.hasKernel();
+    
+    // Start in whichever state we'd end up in, no fade on the first block.
+    if (isUsingDoublePrecision())
+        doubleBypass.reset(shouldProcess(false));
+    else
+        floatBypass.reset(shouldProcess(false));
+    
+    // We're on the message thread here, no need to go through handleAsyncUpdate().
+    cancelPendingUpdate();
+    pendingLatencySamples.store(getCurrentLatency());
+    setLatencySamples(pendingLatencySamples.load());
+    
+    updateTailLength();
+    silentSamples = 0;
+    sleeping = false;
+    
+   #if EELEQ_PROFILING
+    profiler.prepare(sampleRate);
+    floatChain.setProfiler(&profiler);
+    doubleChain.setProfiler(&profiler);
+   #endif
     
     //preparar FIFOS
-    leftChannelFifo.prepare(samplesPerBlock);
-    rightChannelFifo.prepare(samplesPerBlock);
+    analyzerFifo.prepare(samplesPerBlock);
     
     //Preparar el oscilador auxiliar...
     osc.initialise([](float x){return std::sin(x);}); // esta función lambda pasa una sinoidal
@@ -134,18 +231,20 @@ bool EelEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) co
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any channel count works (mono, stereo, 7.1.4 beds, ambisonics...), the chain
+    // gives every channel its own SIMD lane and all of them share the coefficients.
+    if (layouts.getMainOutputChannelSet().isDisabled()
+     || layouts.getMainOutputChannels() > maxNumChannels)
         return false;
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+    
+    // The sidechain is summed to mono for the detector, off, mono or stereo.
+    if (layouts.inputBuses.size() > 1 && layouts.getChannelSet(true, 1).size() > 2)
+        return false;
    #endif
 
     return true;
@@ -154,6 +253,31 @@ bool EelEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) co
 #endif
 
 void EelEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples(buffer, floatChain, floatOversampler, floatBypass, false);
+}
+
+void EelEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    // Double host buffers go through the double chain as they are, no per block conversion.
+    processSamples(buffer, doubleChain, doubleOversampler, doubleBypass, false);
+}
+
+void EelEQAudioProcessor::processBlockBypassed (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    // Same path, the chain keeps running until the fade to dry is done.
+    processSamples(buffer, floatChain, floatOversampler, floatBypass, true);
+}
+
+void EelEQAudioProcessor::processBlockBypassed (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    processSamples(buffer, doubleChain, doubleOversampler, doubleBypass, true);
+}
+
+template<typename SampleType>
+void EelEQAudioProcessor::processSamples (juce::AudioBuffer<SampleType>& hostBuffer, SIMDChain<SampleType>& chain,
+                                          ChainOversampler<SampleType>& oversampler, BypassFader<SampleType>& bypass,
+                                          bool hostBypassed)
 {
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
@@ -166,7 +290,12 @@ void EelEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::
     // when they first compile a plugin, but obviously you don't need to keep
     // this code if your algorithm always overwrites all the output channels.
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
-        buffer.clear (i, 0, buffer.getNumSamples());
+        hostBuffer.clear (i, 0, hostBuffer.getNumSamples());
+    
+    // The sidechain bus only keys the dynamic peak, everything else runs on the main bus.
+    auto buffer = getBusBuffer(hostBuffer, false, 0);
+    
+    EELEQ_PROFILE_BLOCK(profiler, buffer.getNumSamples());
 
     // This is the place where you'd normally do the guts of your plugin's
     // audio processing...
@@ -176,10 +305,16 @@ void EelEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::
     // interleaved by keeping the same state.
     
     
-    UpdateFilters();
+    {
+        EELEQ_PROFILE(&profiler, ProfilerStage_Parameters);
+        UpdateFilters();
+        UpdateLinearPhase();
+    }
+    
+    designCounter.advance(buffer.getNumSamples());
     
     // Definir la instancia del AudioBlock
-    juce::dsp::AudioBlock<float> block(buffer);
+    juce::dsp::AudioBlock<SampleType> block(buffer);
     
     
     //Oscilador de calibración para la FFT: (por el momento está apagado)
@@ -191,21 +326,218 @@ void EelEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::
     
     
     
-    // Extraer los canales dentro del AudioBlock
-    auto leftBlock = block.getSingleChannelBlock(0);
-    auto rightBlock = block.getSingleChannelBlock(1);
+    auto numSamples = buffer.getNumSamples();
+    auto inputIsSilent = buffer.getMagnitude(0, numSamples) == (SampleType)0;
+    
+    if (inputIsSilent)
+        silentSamples = juce::jmin(silentSamples + numSamples, 1 << 30);
+    else
+        silentSamples = 0;
+    
+    // Asleep: the filters were flushed and the input is still silent, so is the output.
+    if (sleeping && inputIsSilent)
+    {
+        buffer.clear();
+        reportLatency();
+        
+        EELEQ_PROFILE(&profiler, ProfilerStage_AnalyzerTap);
+        analyzerFifo.update(buffer);
+        
+        return;
+    }
+    
+    // Waking up from flushed state is exact: it's what silence would have left behind.
+    sleeping = false;
+    
+    // Dynamic bell: the detector runs over the whole block first, the control ticks read it.
+    auto dynamic = isDynamicPeakRunning();
+    blockPosition = 0;
+    
+    if (dynamic)
+    {
+        const auto& settings = channelSets[0].designer.getLatest().settings;
+        
+        if (dynamicPeak.usesSidechain() && getChannelCountOfBus(true, 1) > 0)
+            dynamicPeak.pushKey(getBusBuffer(hostBuffer, true, 1), settings.peakFreq, settings.peakQuality);
+        else
+            dynamicPeak.pushKey(buffer, settings.peakFreq, settings.peakQuality);
+    }
+    
+    auto latency = getCurrentLatency();
+    auto processing = shouldProcess(hostBypassed);
+    
+    // Coming back from the fast path: the chain sat out, start it clean and let it
+    // run for its latency before fading it in.
+    if (processing && bypass.isBypassed())
+    {
+        chain.reset();
+        oversampler.reset();
+        convolver.reset();
+    }
+    
+    bypass.setProcessing(processing, latency);
+    
+    if (bypass.isBypassed())
+    {
+        bypass.processBypassed(block, latency);
+    }
+    else if (!bypass.isFading())
+    {
+        bypass.pushInput(block, latency);
+        processChain(block, chain, oversampler);
+    }
+    else
+    {
+        auto maxLength = bypass.getMaximumBlockSize();
+        
+        for (int start = 0; start < numSamples; start += maxLength)
+        {
+            auto subBlock = block.getSubBlock((size_t)start, (size_t)juce::jmin(maxLength, numSamples - start));
+            
+            bypass.pushInput(subBlock, latency);
+            processChain(subBlock, chain, oversampler);
+            bypass.mixIn(subBlock);
+        }
+    }
+    
+    if (dynamic)
+        dynamicPeak.finishBlock();
+    
+    updateTailLength();
+    reportLatency();
+    
+    // Silent for longer than the tail, and the tail has actually died down: flush and sleep.
+    // (A dynamic bell keeps its band "ramping" for good, only a real parameter ramp holds this off.)
+    auto tailSamples = tailLengthSeconds.load() * getSampleRate();
+    
+    if (inputIsSilent && silentSamples > tailSamples
+        && !bypass.isFading() && !isSmoothing()
+        && buffer.getMagnitude(0, numSamples) < outputSilenceThreshold)
+    {
+        chain.reset();
+        oversampler.reset();
+        convolver.reset();
+        dynamicPeak.reset();
+        sleeping = true;
+    }
+    
+    //Update to Fifo's (Channel::Left is index 1, mono feeds both sides;
+    //surround only shows the front pair)
+    EELEQ_PROFILE(&profiler, ProfilerStage_AnalyzerTap);
+    analyzerFifo.update(buffer);
+    
+}
+
+template<typename SampleType>
+void EelEQAudioProcessor::processChain (juce::dsp::AudioBlock<SampleType>& block, SIMDChain<SampleType>& chain,
+                                        ChainOversampler<SampleType>& oversampler)
+{
+    if (linearPhaseActive)
+    {
+        convolver.process(block);
+    }
+    else if (!isRamping() && !isDynamicPeakRunning())
+    {
+        oversampler.process(block, chain);
+        samplesUntilControlTick = 0;
+    }
+    else
+    {
+        // Something is moving (a ramp, or the dynamic bell): redesign those bands every controlRate samples.
+        // The tick counter carries over between blocks, so the result doesn't depend on the host buffer size.
+        auto controlRate = getControlRateInSamples(juce::roundToInt(controlRateParameter->load()));
+        auto numSamples = (int)block.getNumSamples();
+        int start = 0;
+        
+        while (start < numSamples)
+        {
+            if (samplesUntilControlTick <= 0)
+            {
+                EELEQ_PROFILE(&profiler, ProfilerStage_Coefficients);
+                
+                for (int set = 0; set < getNumActiveChannelSets(); ++set)
+                {
+                    UpdateSmoothedBands(channelSets[(size_t)set], blockPosition + start);
+                    channelSets[(size_t)set].smoother.skip(controlRate);
+                }
+                
+                samplesUntilControlTick = controlRate;
+            }
+            
+            auto length = juce::jmin(samplesUntilControlTick, numSamples - start);
+            auto subBlock = block.getSubBlock((size_t)start, (size_t)length);
+            oversampler.process(subBlock, chain);
+            
+            start += length;
+            samplesUntilControlTick -= length;
+        }
+    }
+    
+    blockPosition += (int)block.getNumSamples();
+    
+}
+
+bool EelEQAudioProcessor::isDynamicPeakRunning() const
+{
+    // The linear phase kernel can't follow it, there the bell stays at "Peak Gain".
+    // Only the first channel set has one.
+    const auto& settings = channelSets[0].designer.getLatest().settings;
+    
+    return settings.peakDynamic && isBandActive(settings, ChainPositions::Peak) && !linearPhaseActive;
+}
+
+bool EelEQAudioProcessor::shouldProcess(bool hostBypassed) const
+{
+    // A ramp may be heading for neutral, it still has to be heard getting there.
+    if (hostBypassed)
+        return false;
+    
+    if (isRamping())
+        return true;
+    
+    for (int set = 0; set < getNumActiveChannelSets(); ++set)
+        if (isAnyBandActive(channelSets[(size_t)set].designer.getLatest().settings))
+            return true;
+    
+    return false;
+}
+
+void EelEQAudioProcessor::updateTailLength(){
+    
+    auto sampleRate = getSampleRate();
+    
+    if (sampleRate <= 0.0)
+        return;
+    
+    // The linear phase kernel rings for the half after its peak (the minimum phase
+    // chain's own tail is inside it), the latency comes on top either way.
+    auto chainTailSeconds = 0.0;
+    
+    for (int set = 0; set < getNumActiveChannelSets(); ++set)
+        chainTailSeconds = juce::jmax(chainTailSeconds, channelSets[(size_t)set].tailSeconds);
+    
+    auto responseTail = linearPhaseActive ? (LinearPhaseKernelLength / 2) / sampleRate
+                                          : chainTailSeconds;
     
-    // Crear el ProcessContext
-    juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+    tailLengthSeconds.store(responseTail + getCurrentLatency() / sampleRate);
     
-    // Pasar el contexto a las cadenas
-    leftChain.process(leftContext);
-    rightChain.process(rightContext);
+}
+
+void EelEQAudioProcessor::updateCrossfadeLengths(){
     
-    //Update to Fifo's
-    leftChannelFifo.update(buffer);
-    rightChannelFifo.update(buffer);
+    auto hostRateLength = juce::roundToInt(crossfadeTimeSeconds * getSampleRate());
+    
+    // The chains run at the oversampled rate.
+    if (isUsingDoublePrecision())
+    {
+        doubleBypass.setCrossfadeLength(hostRateLength);
+        doubleChain.setCrossfadeLength(hostRateLength * getOversamplingFactor(getOversamplingOrder()));
+    }
+    else
+    {
+        floatBypass.setCrossfadeLength(hostRateLength);
+        floatChain.setCrossfadeLength(hostRateLength * getOversamplingFactor(getOversamplingOrder()));
+    }
     
 }
 
@@ -246,7 +578,10 @@ void EelEQAudioProcessor::setStateInformation (const void* data, int sizeInBytes
     if(tree.isValid()){
         
         apvts.replaceState(tree);
-        UpdateFilters();
+        
+        // Don't touch the chains from here, the designer thread picks the new values up.
+        for (auto& channelSet : channelSets)
+            channelSet.designer.triggerUpdate();
         
     }
     
@@ -256,112 +591,361 @@ void EelEQAudioProcessor::setStateInformation (const void* data, int sizeInBytes
 //==============================================================================
 
 
-ChainSettings getChainSettings (juce::AudioProcessorValueTreeState& apvts){
+void UpdateCoefficients(Filter& filter, const BiquadCoefficients& replacements){
     
-    ChainSettings settings;
+    auto& coefficients = *filter.coefficients;
     
+    // prepareBiquads() wasn't called on this chain?
+    jassert(coefficients.coefficients.size() == 5);
     
-    //HPF y LPF
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
-    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
+    auto* raw = coefficients.getRawCoefficients();
     
+    raw[0] = static_cast<float>(replacements.b0);
+    raw[1] = static_cast<float>(replacements.b1);
+    raw[2] = static_cast<float>(replacements.b2);
+    raw[3] = static_cast<float>(replacements.a1);
+    raw[4] = static_cast<float>(replacements.a2);
     
-    //Bell
-    settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
-    settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
-    settings.peakQuality = apvts.getRawParameterValue("Quality")->load();
+}
+
+void prepareBiquads(MonoChain& chain){
+    
+    // Unity biquad, the real values arrive with the first UpdateChainCoefficients()
+    auto makeBiquad = []
+    {
+        return new juce::dsp::IIR::Coefficients<float>(1.f, 0.f, 0.f, 1.f, 0.f, 0.f);
+    };
+    
+    auto prepareCut = [&makeBiquad](CutFilter& cut)
+    {
+        cut.get<0>().coefficients = makeBiquad();
+        cut.get<1>().coefficients = makeBiquad();
+        cut.get<2>().coefficients = makeBiquad();
+        cut.get<3>().coefficients = makeBiquad();
+    };
+    
+    prepareCut(chain.get<ChainPositions::LowCut>());
+    chain.get<ChainPositions::Peak>().coefficients = makeBiquad();
+    prepareCut(chain.get<ChainPositions::HighCut>());
     
-    //Bypass Settings
-    settings.lowCutBypassed = apvts.getRawParameterValue("LowCut Bypassed")->load() > 0.5f;
-    settings.highCutBypassed = apvts.getRawParameterValue("HighCut Bypassed")->load() > 0.5f;
-    settings.peakBypassed = apvts.getRawParameterValue("Peak Bypassed")->load() > 0.5f;
+}
+
+void UpdateBandCoefficients(MonoChain& chain, const ChainCoefficients& chainCoefficients, ChainPositions band){
+    
+    const auto& chainSettings = chainCoefficients.settings;
+    
+    switch (band)
+    {
+        case ChainPositions::Peak:
+            chain.setBypassed<ChainPositions::Peak>(!isBandActive(chainSettings, band));
+            UpdateCoefficients(chain.get<ChainPositions::Peak>(), chainCoefficients.peak);
+            break;
+            
+        //HighPass Filter
+        case ChainPositions::LowCut:
+            chain.setBypassed<ChainPositions::LowCut>(!isBandActive(chainSettings, band));
+            UpdateCutFilter(chain.get<ChainPositions::LowCut>(), chainCoefficients.lowCut, chainSettings.lowCutSlope);
+            break;
+            
+        // LowPass Filter
+        case ChainPositions::HighCut:
+            chain.setBypassed<ChainPositions::HighCut>(!isBandActive(chainSettings, band));
+            UpdateCutFilter(chain.get<ChainPositions::HighCut>(), chainCoefficients.highCut, chainSettings.highCutSlope);
+            break;
+    }
     
-    return settings;
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate){
+void UpdateChainCoefficients(MonoChain& chain, const ChainCoefficients& chainCoefficients){
     
-     return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-                                                                chainSettings.peakFreq, chainSettings.peakQuality,
-                                                                juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+    UpdateBandCoefficients(chain, chainCoefficients, ChainPositions::LowCut);
+    UpdateBandCoefficients(chain, chainCoefficients, ChainPositions::Peak);
+    UpdateBandCoefficients(chain, chainCoefficients, ChainPositions::HighCut);
     
 }
 
+void EelEQAudioProcessor::UpdateFilters(){
+    
+    updateChannelMode();
+    
+    for (int set = 0; set < getNumActiveChannelSets(); ++set)
+        UpdateFilters(channelSets[(size_t)set]);
+    
+}
 
+void EelEQAudioProcessor::UpdateFilters(ChannelSet& channelSet){
+    
+    // Swap in whatever the designer thread published last, the designing already happened over there.
+    if (channelSet.designer.pullLatest())
+    {
+        const auto& target = channelSet.designer.getLatest();
+        
+        channelSet.smoother.setTarget(target.settings);
+        channelSet.tailSeconds = getChainTailInSeconds(target);
+        
+        // New oversampling order: every band was redesigned for the new rate, the old
+        // filter state means nothing there. Take the whole set, ramps pick up at the next tick.
+        // (The second set's designer may still be on the old rate, it catches up when it publishes.)
+        if (target.settings.oversamplingOrder != getOversamplingOrder())
+        {
+            setOversamplingOrder(target.settings.oversamplingOrder);
+            
+            if (isUsingDoublePrecision())
+                doubleChain.reset();
+            else
+                floatChain.reset();
+            
+            setChainCoefficients(target, channelSet.index);
+            samplesUntilControlTick = 0;
+        }
+        
+        // Bands that aren't moving take the designer's coefficients as they are,
+        // the ramping ones get redesigned at control rate until they land on the target.
+        for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+        {
+            if (!channelSet.smoother.isSmoothing(band) && !channelSet.bandRamping[band])
+            {
+                setBandCoefficients(target, band, channelSet.index);
+            }
+        }
+        
+        // The user bands aren't smoothed, they follow the designer.
+        if (channelSet.index == 0)
+            setUserBandCoefficients(target);
+    }
+    
+}
 
-//Definimos la función auxiliar que nos ayudara a actualizar los parametros del peak filter...
-void EelEQAudioProcessor::UpdatePeakFilter(const ChainSettings &chainSettings){
+ChannelMode EelEQAudioProcessor::getChannelModeForLayout() const{
     
-   /* auto peakCoefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),
-                                                                                chainSettings.peakFreq, chainSettings.peakQuality,
-                                                                                juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels)); */
+    // Left/Right and Mid/Side only mean something for a stereo pair. Linear phase has one
+    // kernel for every channel, so the minimum phase chain doesn't split either while
+    // it's asked for (no jump when the kernel takes over, the "Ch2" set sits out).
+    if (getMainBusNumInputChannels() != 2 || phaseModeParameter->load() > 0.5f)
+        return ChannelMode::ChannelMode_Stereo;
     
-    auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+    return static_cast<ChannelMode>(juce::roundToInt(channelModeParameter->load()));
     
-    leftChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
-    rightChain.setBypassed<ChainPositions::Peak>(chainSettings.peakBypassed);
+}
+
+bool EelEQAudioProcessor::isChannelModeOverridden() const{
     
-    UpdateCoefficients(leftChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-    UpdateCoefficients(rightChain.get<ChainPositions::Peak>().coefficients, peakCoefficients);
-   
+    return getMainBusNumInputChannels() == 2 && phaseModeParameter->load() > 0.5f
+        && juce::roundToInt(channelModeParameter->load()) != ChannelMode::ChannelMode_Stereo;
     
 }
 
+void EelEQAudioProcessor::updateChannelMode(){
+    
+    auto mode = getChannelModeForLayout();
+    
+    if (mode == channelMode)
+        return;
+    
+    // The lanes change meaning, the chain starts over from silence with every set's
+    // latest coefficients. No ramps, there's nothing to ramp from.
+    channelMode = mode;
+    
+    if (isUsingDoublePrecision())
+        doubleChain.setChannelMode(mode);
+    else
+        floatChain.setChannelMode(mode);
+    
+    for (auto& channelSet : channelSets)
+        channelSet.designer.setEnabled(channelSet.index < getNumActiveChannelSets());
+    
+    for (int set = 0; set < getNumActiveChannelSets(); ++set)
+    {
+        auto& channelSet = channelSets[(size_t)set];
+        
+        // The second set's designer isn't pulled from (or run) while it sits out. If its
+        // parameters moved meanwhile it starts from its last set and ramps over once the
+        // designer has caught up.
+        channelSet.designer.pullLatest();
+        const auto& latest = channelSet.designer.getLatest();
+        
+        channelSet.smoother.setCurrentAndTarget(latest.settings);
+        channelSet.bandRamping.fill(false);
+        channelSet.tailSeconds = getChainTailInSeconds(latest);
+        
+        setChainCoefficients(latest, set);
+    }
+    
+    samplesUntilControlTick = 0;
+    
+}
 
-void UpdateCoefficients(Coefficients& old, const Coefficients &replacements){
+void EelEQAudioProcessor::setChainCoefficients(const ChainCoefficients& chainCoefficients, int channelSet){
+    
+    for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+        setBandCoefficients(chainCoefficients, band, channelSet);
     
-    *old = *replacements;
+    if (channelSet == 0)
+        setUserBandCoefficients(chainCoefficients);
     
 }
 
-void EelEQAudioProcessor::UpdateLowCut(const ChainSettings &chainSettings){
+void EelEQAudioProcessor::setBandCoefficients(const ChainCoefficients& chainCoefficients, ChainPositions band, int channelSet){
+    
+    // "Stereo": the first set on every lane.
+    auto lanes = channelMode == ChannelMode::ChannelMode_Stereo ? SIMDChain<float>::AllChannelSets : channelSet;
     
-    //HighPass Filter
+    if (isUsingDoublePrecision())
+        doubleChain.setBandCoefficients(chainCoefficients, band, lanes);
+    else
+        floatChain.setBandCoefficients(chainCoefficients, band, lanes);
+    
+}
 
-    auto cutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
+void EelEQAudioProcessor::setUserBandCoefficients(const ChainCoefficients& chainCoefficients){
+    
+    if (isUsingDoublePrecision())
+        doubleChain.setUserBandCoefficients(chainCoefficients);
+    else
+        floatChain.setUserBandCoefficients(chainCoefficients);
+    
+}
 
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
+int EelEQAudioProcessor::getOversamplingOrder() const{
+    
+    return isUsingDoublePrecision() ? doubleOversampler.getOrder() : floatOversampler.getOrder();
     
-    leftChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
-    rightChain.setBypassed<ChainPositions::LowCut>(chainSettings.lowCutBypassed);
+}
+
+void EelEQAudioProcessor::setOversamplingOrder(int order){
     
+    if (isUsingDoublePrecision())
+        doubleOversampler.setOrder(order);
+    else
+        floatOversampler.setOrder(order);
     
-    UpdateCutFilter(leftLowCut, cutCoefficients, chainSettings.lowCutSlope);
-    UpdateCutFilter(rightLowCut, cutCoefficients, chainSettings.lowCutSlope);
+    updateCrossfadeLengths();
     
+}
+
+void EelEQAudioProcessor::UpdateLinearPhase(){
+    
+    auto wantsLinearPhase = phaseModeParameter->load() > 0.5f;
+    
+    // A new kernel waits for the running crossfade to finish, it'll still be the latest next block.
+    if (wantsLinearPhase && !convolver.isCrossfading() && linearPhaseDesigner.pullLatest())
+        convolver.setKernel(linearPhaseDesigner.getLatest());
+    
+    // Stay on the minimum phase chain until the first kernel has arrived.
+    auto active = wantsLinearPhase && convolver.hasKernel();
+    
+    if (active != linearPhaseActive)
+    {
+        // Neither path's state means anything to the other one, start clean.
+        if (active)
+            convolver.reset();
+        else if (isUsingDoublePrecision())
+            doubleChain.reset();
+        else
+            floatChain.reset();
+        
+        linearPhaseActive = active;
+    }
     
 }
 
-void EelEQAudioProcessor::UpdateHighCut(const ChainSettings &chainSettings){
+int EelEQAudioProcessor::getCurrentLatency() const{
+    
+    if (linearPhaseActive)
+        return convolver.getLatencyInSamples();
     
-    // LowPass Filter
+    auto order = getOversamplingOrder();
     
-    auto highcutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
+    return isUsingDoublePrecision() ? doubleOversampler.getLatencyInSamples(order)
+                                    : floatOversampler.getLatencyInSamples(order);
     
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
+}
+
+void EelEQAudioProcessor::reportLatency(){
     
-    leftChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
-    rightChain.setBypassed<ChainPositions::HighCut>(chainSettings.highCutBypassed);
+    auto latency = getCurrentLatency();
     
-    UpdateCutFilter(leftHighCut, highcutCoefficients, chainSettings.highCutSlope);
-    UpdateCutFilter(rightHighCut, highcutCoefficients, chainSettings.highCutSlope);
+    if (latency != pendingLatencySamples.load())
+    {
+        pendingLatencySamples.store(latency);
+        triggerAsyncUpdate();
+    }
     
+}
+
+void EelEQAudioProcessor::handleAsyncUpdate(){
     
+    setLatencySamples(pendingLatencySamples.load());
     
 }
 
-void EelEQAudioProcessor::UpdateFilters(){
+bool EelEQAudioProcessor::isRamping() const
+{
+    for (int set = 0; set < getNumActiveChannelSets(); ++set)
+    {
+        const auto& bandRamping = channelSets[(size_t)set].bandRamping;
+        
+        if (channelSets[(size_t)set].smoother.isSmoothing()
+            || bandRamping[ChainPositions::LowCut]
+            || bandRamping[ChainPositions::Peak]
+            || bandRamping[ChainPositions::HighCut])
+            return true;
+    }
     
-    auto chainSettings = getChainSettings(apvts);
+    return false;
+}
+
+bool EelEQAudioProcessor::isSmoothing() const
+{
+    for (int set = 0; set < getNumActiveChannelSets(); ++set)
+        if (channelSets[(size_t)set].smoother.isSmoothing())
+            return true;
     
-    UpdatePeakFilter(chainSettings);
-    UpdateLowCut(chainSettings);
-    UpdateHighCut(chainSettings);
+    return false;
+}
+
+void EelEQAudioProcessor::UpdateSmoothedBands(ChannelSet& channelSet, int position){
+    
+    // Runs once per control tick while ramping. Allocation free, a cut design is a single tan().
+    const auto& target = channelSet.designer.getLatest();
+    const auto& smoother = channelSet.smoother;
+    auto& rampCoefficients = channelSet.rampCoefficients;
+    auto& bandRamping = channelSet.bandRamping;
+    
+    rampCoefficients.settings = smoother.getCurrentSettings(target.settings);
+    rampCoefficients.sampleRate = target.sampleRate;
+    
+    // The dynamic bell gets redesigned every tick, with the gain the detector asks for
+    // (the smoothed "Peak Gain" is its range). The first set's bell only.
+    auto dynamic = channelSet.index == 0 && isDynamicPeakRunning();
+    
+    if (dynamic)
+        rampCoefficients.settings.peakGainInDecibels = dynamicPeak.getGainInDecibels(position, rampCoefficients.settings.peakGainInDecibels);
+    
+    int numDesigns = 0;
+    
+    for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+    {
+        if (smoother.isSmoothing(band) || (dynamic && band == ChainPositions::Peak))
+        {
+            if (isBandActive(rampCoefficients.settings, band))
+            {
+                designBand(rampCoefficients, band);
+                ++numDesigns;
+            }
+            
+            setBandCoefficients(rampCoefficients, band, channelSet.index);
+            bandRamping[band] = true;
+        }
+        else if (bandRamping[band])
+        {
+            // Landed, the designer already has the exact target for this band.
+            setBandCoefficients(target, band, channelSet.index);
+            bandRamping[band] = false;
+        }
+    }
     
+    designCounter.addDesigns(numDesigns);
     
 }
 
@@ -440,6 +1024,90 @@ juce::AudioProcessorValueTreeState::ParameterLayout EelEQAudioProcessor::createP
                                                             0)
                );
     
+    // How often the ramping bands get redesigned (CPU vs smoothness)...
+    layout.add(
+               std::make_unique<juce::AudioParameterChoice>("Control Rate",
+                                                            "Control Rate",
+                                                            getControlRateChoices(),
+                                                            1)
+               );
+    
+    // Runs the whole chain at 1x - 8x the host rate (un-cramps the bells near Nyquist, adds latency)...
+    layout.add(
+               std::make_unique<juce::AudioParameterChoice>("Oversampling",
+                                                            "Oversampling",
+                                                            getOversamplingChoices(),
+                                                            0)
+               );
+    
+    // Minimum phase (the biquads) or the same curve as a linear phase FIR, with its latency...
+    layout.add(
+               std::make_unique<juce::AudioParameterChoice>("Phase Mode",
+                                                            "Phase Mode",
+                                                            juce::StringArray { "Minimum Phase", "Linear Phase" },
+                                                            0)
+               );
+    
+    // Linear phase block size: smaller = less latency, more CPU...
+    layout.add(
+               std::make_unique<juce::AudioParameterChoice>("Partition Size",
+                                                            "Partition Size",
+                                                            getPartitionSizeChoices(),
+                                                            1)
+               );
+    
+    // Serial biquads or parallel sections for the 24/36/48 dB cuts (same response)...
+    layout.add(
+               std::make_unique<juce::AudioParameterChoice>("Cut Structure",
+                                                            "Cut Structure",
+                                                            juce::StringArray { "Cascade", "Parallel" },
+                                                            0)
+               );
+    
+    // RBJ bilinear bell or one matched to the analog magnitude (no cramping near Nyquist)...
+    layout.add(
+               std::make_unique<juce::AudioParameterChoice>("Peak Design",
+                                                            "Peak Design",
+                                                            juce::StringArray { "Bilinear", "Matched" },
+                                                            0)
+               );
+    
+    // Dynamic bell: "Peak Gain" becomes the range, the detector listens at the bell's frequency and Q...
+    layout.add(std::make_unique<juce::AudioParameterBool>("Peak Dynamic",
+                                                          "Peak Dynamic",
+                                                          false));
+    layout.add(
+               std::make_unique<juce::AudioParameterFloat>("Dynamic Threshold",
+                                                           "Dynamic Threshold",
+                                                           juce::NormalisableRange<float>(-60.f, 0.f, 0.1f, 1.f),
+                                                           -24.f
+                                                           )
+               );
+    layout.add(
+               std::make_unique<juce::AudioParameterFloat>("Dynamic Ratio",
+                                                           "Dynamic Ratio",
+                                                           juce::NormalisableRange<float>(1.f, 20.f, 0.1f, 0.5f),
+                                                           4.f
+                                                           )
+               );
+    layout.add(
+               std::make_unique<juce::AudioParameterFloat>("Dynamic Attack",
+                                                           "Dynamic Attack",
+                                                           juce::NormalisableRange<float>(0.1f, 200.f, 0.1f, 0.3f),
+                                                           5.f
+                                                           )
+               );
+    layout.add(
+               std::make_unique<juce::AudioParameterFloat>("Dynamic Release",
+                                                           "Dynamic Release",
+                                                           juce::NormalisableRange<float>(5.f, 2000.f, 1.f, 0.3f),
+                                                           120.f
+                                                           )
+               );
+    layout.add(std::make_unique<juce::AudioParameterBool>("Dynamic Sidechain",
+                                                          "Dynamic Sidechain",
+                                                          false));
+    
     
     //Bypass Parameters...
     
@@ -456,6 +1124,99 @@ juce::AudioProcessorValueTreeState::ParameterLayout EelEQAudioProcessor::createP
                                                           "Analyzer Enabled",
                                                           true));
     
+    // Analyzer hop, the FFT size over this (more = smoother, more FFTs)...
+    layout.add(
+               std::make_unique<juce::AudioParameterChoice>("Analyzer Overlap",
+                                                            "Analyzer Overlap",
+                                                            juce::StringArray { "2x", "4x", "8x" },
+                                                            1)
+               );
+    
+    // Analyzer FFT size: 2048 for slow machines, 8192/16384 for detail down low...
+    layout.add(
+               std::make_unique<juce::AudioParameterChoice>("Analyzer Size",
+                                                            "Analyzer Size",
+                                                            juce::StringArray { "2048", "4096", "8192", "16384" },
+                                                            1)
+               );
+    
+    // Analyzer curves: Left/Right, Mid/Side or just the sum, all from one FFT of the pair...
+    layout.add(
+               std::make_unique<juce::AudioParameterChoice>("Analyzer View",
+                                                            "Analyzer View",
+                                                            juce::StringArray { "Left/Right", "Mid/Side", "Sum" },
+                                                            0)
+               );
+    
+    //User Bands...
+    
+    // How many of the "Band N" sets run, after the fixed LowCut/Peak/HighCut...
+    layout.add(std::make_unique<juce::AudioParameterInt>("Band Count",
+                                                         "Band Count",
+                                                         0, MaxUserBands, 0));
+    
+    for (int i = 0; i < MaxUserBands; ++i)
+    {
+        auto id = [i](const juce::String& name) { return getUserBandParameterID(i, name); };
+        
+        // Spread over the spectrum so adding a band doesn't stack it on the previous one.
+        auto defaultFrequency = (float)juce::mapToLog10((i + 0.5) / MaxUserBands, 20.0, 20000.0);
+        
+        layout.add(std::make_unique<juce::AudioParameterChoice>(id("Type"), id("Type"),
+                                                                getBandTypeChoices(), 0));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id("Freq"), id("Freq"),
+                                                               juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.2f),
+                                                               std::round(defaultFrequency)));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id("Gain"), id("Gain"),
+                                                               juce::NormalisableRange<float>(-24.f, 24.f, 0.1f, 1.f),
+                                                               0.f));
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id("Q"), id("Q"),
+                                                               juce::NormalisableRange<float>(0.1f, 15.f, 0.05f, 1.f),
+                                                               0.9f));
+        layout.add(std::make_unique<juce::AudioParameterChoice>(id("Slope"), id("Slope"),
+                                                                stringArray, 0));
+        layout.add(std::make_unique<juce::AudioParameterBool>(id("Bypassed"), id("Bypassed"),
+                                                              false));
+    }
+    
+    // Both channels on the same bands, or Left/Right or Mid/Side each on their own (stereo only)...
+    layout.add(
+               std::make_unique<juce::AudioParameterChoice>("Channel Mode",
+                                                            "Channel Mode",
+                                                            getChannelModeChoices(),
+                                                            0)
+               );
+    
+    //Second channel (Right or Side) copies of the fixed bands, same ranges and defaults...
+    
+    auto ch2 = [](const juce::String& name) { return getChannelSetPrefix(1) + name; };
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>(ch2("LowCut Freq"), ch2("LowCut Freq"),
+                                                           juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.2f),
+                                                           20.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(ch2("HighCut Freq"), ch2("HighCut Freq"),
+                                                           juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.2f),
+                                                           20000.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(ch2("Peak Freq"), ch2("Peak Freq"),
+                                                           juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.2f),
+                                                           1000.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(ch2("Peak Gain"), ch2("Peak Gain"),
+                                                           juce::NormalisableRange<float>(-24.f, 24.f, 0.1f, 1.f),
+                                                           0.f));
+    layout.add(std::make_unique<juce::AudioParameterFloat>(ch2("Quality"), ch2("Quality"),
+                                                           juce::NormalisableRange<float>(0.1f, 15.f, 0.05f, 1.f),
+                                                           0.9f));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(ch2("LowCut Slope"), ch2("LowCut Slope"),
+                                                            stringArray, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>(ch2("HighCut Slope"), ch2("HighCut Slope"),
+                                                            stringArray, 0));
+    layout.add(std::make_unique<juce::AudioParameterBool>(ch2("LowCut Bypassed"), ch2("LowCut Bypassed"),
+                                                          false));
+    layout.add(std::make_unique<juce::AudioParameterBool>(ch2("HighCut Bypassed"), ch2("HighCut Bypassed"),
+                                                          false));
+    layout.add(std::make_unique<juce::AudioParameterBool>(ch2("Peak Bypassed"), ch2("Peak Bypassed"),
+                                                          false));
+    
     return layout;
 }
 
@@ -10,6 +10,18 @@
 
 #include <JuceHeader.h>
 #include <array>
+#include "ChainSettings.h"
+#include "BiquadDesign.h"
+#include "CoefficientDesigner.h"
+#include "ParameterSmoothing.h"
+#include "SIMDChain.h"
+#include "ChainOversampler.h"
+#include "PartitionedConvolver.h"
+#include "LinearPhaseDesigner.h"
+#include "BypassFader.h"
+#include "DynamicPeak.h"
+#include "DspProfiler.h"
+#include "SampleRing.h"
 
 //==============================================================================
 //FFT implementation 3: Fifo type templeate...
@@ -103,102 +115,86 @@ enum Channel{
 
 
 //==============================================================================
-//FFT implementation 2: SingleChannelSampleFifo
+//FFT implementation 2: StereoSampleFifo
+// The front pair of the output for the analyzer, through a SampleRing: the audio thread
+// copies each block in as it is, the editor reads whatever hop it wants straight out.
+// Both channels share the ring's positions, the analyzer transforms them together.
 
-template<typename BlockType>
-struct SingleChannelSampleFifo
+struct StereoSampleFifo
 {
-    SingleChannelSampleFifo(Channel ch) : channelToUse(ch)
+    StereoSampleFifo()
     {
         prepared.set(false);
     }
     
-    void update (const BlockType& buffer){
+    // Takes float or double host buffers, the analyzer itself always runs in float.
+    // Mono goes to both sides. A block the reader hasn't left room for is dropped,
+    // of a huge one only the end goes in (the analyzer only looks at the last window anyway).
+    template<typename SourceBufferType>
+    void update (const SourceBufferType& buffer){
         
         jassert(prepared.get());
-        jassert(buffer.getNumChannels() > channelToUse );
-        auto* channelPtr = buffer.getReadPointer(channelToUse);
+        jassert(buffer.getNumChannels() > 0);
         
-        for (int i = 0; i < buffer.getNumSamples(); ++i){
-            
-            pushNextSampleIntoFifo(channelPtr[i]);
-            
-        }
+        auto lastChannel = buffer.getNumChannels() - 1;
+        auto numSamples = juce::jmin(buffer.getNumSamples(), maximumBlockSize);
+        auto start = buffer.getNumSamples() - numSamples;
+        
+        // Ring channels in Channel order (Channel::Right is buffer channel 0).
+        decltype(buffer.getReadPointer(0)) sources[] = { buffer.getReadPointer(juce::jmin((int)Channel::Right, lastChannel), start),
+                                                         buffer.getReadPointer(juce::jmin((int)Channel::Left, lastChannel), start) };
+        
+        auto ok = ring.write(sources, numSamples);
+        juce::ignoreUnused(ok);
     }
     
+    // Not realtime safe. The ring is allocated once, for the biggest analyzer window
+    // and a good few blocks on top, here it only gets emptied. The writer is stopped
+    // (prepareToPlay), the reader is kept out with the reader lock.
     void prepare(int bufferSize){
         
+        const juce::ScopedLock sl(readerLock);
+        
         prepared.set(false);
         size.set(bufferSize);
         
-        bufferToFill.setSize(1,          //Canal
-                             bufferSize, //num of samples
-                             false,      //keep existing content
-                             true,       //clear extra space
-                             true);      //avoid reallocating
-        
-        audioBufferFifo.prepare(1, bufferSize);
-        fifoIndex = 0;
+        ring.reset();
         prepared.set(true);
     }
     //===========
     
-    int getNumCompleteBuffersAvailable() const { return audioBufferFifo.getNumAvailableForReading();}
+    int getNumSamplesAvailable() const { return ring.getNumReady(); }
     bool isPrepared() const {return prepared.get();}
     int getSize() const {return size.get();}
     
     //===========
-    bool getAudioBuffer(BlockType& buf){return audioBufferFifo.pull(buf);}
-    
-private:
-    Channel channelToUse;
-    int fifoIndex = 0;
-    Fifo<BlockType> audioBufferFifo;
-    BlockType bufferToFill;
-    juce::Atomic<bool> prepared = false;
-    juce::Atomic<int> size = 0;
+    // Reader side: numSamples of both channels at once or nothing, and dropping the oldest to catch up.
+    bool pull(float* right, float* left, int numSamples)
+    {
+        float* destinations[] = { right, left };
+        return ring.read(destinations, numSamples);
+    }
     
+    void skip(int numSamples){ ring.skip(numSamples); }
     
-    void pushNextSampleIntoFifo(float sample){
-        
-        if (fifoIndex == bufferToFill.getNumSamples()){
-            
-            auto ok = audioBufferFifo.push(bufferToFill);
-            juce::ignoreUnused(ok);
-            fifoIndex = 0;
-            
-        }
+    // The reader holds it around everything it does with the fifo (the analyzer worker
+    // runs while the editor is open, prepareToPlay can come in at any time). Never the audio thread.
+    const juce::CriticalSection& getReaderLock() const { return readerLock; }
     
-        bufferToFill.setSample(0,fifoIndex,sample);
-        ++fifoIndex;
+private:
+    static constexpr int numChannels = 2;
+    static constexpr int capacity = 1 << 16;
+    static constexpr int maximumBlockSize = capacity / 4;
     
-    }
+    SampleRing ring {numChannels, capacity};
+    juce::CriticalSection readerLock;
+    juce::Atomic<bool> prepared = false;
+    juce::Atomic<int> size = 0;
 };
 
 //==============================================================================
 
 
-enum Slope {
-    
-    Slope_12,
-    Slope_24,
-    Slope_36,
-    Slope_48
-    
-};
-
-
-struct ChainSettings {
-  
-    float peakFreq {0}, peakGainInDecibels{0}, peakQuality{0};
-    float lowCutFreq{0}, highCutFreq{0};
-    Slope  lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
-    bool lowCutBypassed {false}, highCutBypassed {false}, peakBypassed{false};
-
-};
-
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
-
 using Filter = juce::dsp::IIR::Filter<float>;
 
 using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
@@ -206,16 +202,16 @@ using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
 using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>; // How the signal moves throguh the plugin
 
 
-enum ChainPositions {
-    LowCut,
-    Peak,
-    HighCut
-};
+// Copies designed coefficients into the Filter's existing storage, no allocation.
+void UpdateCoefficients (Filter& filter, const BiquadCoefficients& replacements);
 
-using Coefficients = Filter::CoefficientsPtr;
-void UpdateCoefficients (Coefficients& old, const Coefficients& replacements);
+// Gives every Filter in the chain 2nd order coefficient storage so UpdateCoefficients()
+// is a plain copy from then on. Call it before prepare(), off the audio thread.
+void prepareBiquads(MonoChain& chain);
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
+// Applies a complete coefficient set (and the bypass states) to a chain, or just one band of it.
+void UpdateChainCoefficients(MonoChain& chain, const ChainCoefficients& chainCoefficients);
+void UpdateBandCoefficients(MonoChain& chain, const ChainCoefficients& chainCoefficients, ChainPositions band);
 
 
 template<int Index,typename ChainType, typename CoefficientType>
@@ -223,7 +219,7 @@ void updateSlopes(ChainType& chain, CoefficientType& cutCoeffients)
     {
        
         // Actualizar los coeficientes, desactivar el bypass de la cadena.
-        *chain.template get<Index>().coefficients = *cutCoeffients[Index];
+        UpdateCoefficients(chain.template get<Index>(), cutCoeffients.sections[Index]);
         chain.template setBypassed<Index>(false);
         
     }
@@ -273,29 +269,11 @@ void UpdateCutFilter(ChainType &chain,
 
 
 
-
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate){
-    
-    return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq, sampleRate, 2*(chainSettings.lowCutSlope + 1));
-
-    
-}
-
-inline auto makeHighCutFilter (const ChainSettings& chainSettings, double sampleRate){
-    
-    
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq, sampleRate, 2*(chainSettings.highCutSlope +1));
-    
-}
-
-
-
-
-
 //==============================================================================
 /**
 */
-class EelEQAudioProcessor  : public juce::AudioProcessor
+class EelEQAudioProcessor  : public juce::AudioProcessor,
+                             private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -311,6 +289,13 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    
+    // Latency compensated dry signal, crossfaded in and out like any other bypass.
+    void processBlockBypassed (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlockBypassed (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -345,21 +330,145 @@ public:
 
     // Crear las instancias de los FIFO y el namespace para poder declarar pointers de forma facil.
     
-    using BlockType = juce::AudioBuffer<float>;
-    SingleChannelSampleFifo<BlockType> leftChannelFifo {Channel::Left};
-    SingleChannelSampleFifo<BlockType> rightChannelFifo{Channel::Right};
+    StereoSampleFifo analyzerFifo;
+    
+    // Coefficient designs per second of audio (0 when nothing is moving).
+    float getDesignsPerSecond() const { return designCounter.getDesignsPerSecond(); }
+    
+    // "Channel Mode" is set to split the channels but linear phase runs them all as Stereo.
+    bool isChannelModeOverridden() const;
+    
+   #if EELEQ_PROFILING
+    // Audio thread timings (DspProfiler.h), profiling builds only.
+    const DspProfiler& getProfiler() const { return profiler; }
+    void resetProfiler() { profiler.reset(); }
+   #endif
     
 private:
     
     
-    MonoChain leftChain, rightChain; // Stereo capabilities.
+    // LowCut x4 -> Peak -> HighCut x4 on every channel at once, one SIMD lane per channel.
+    // Only the one matching the host's processing precision gets prepared and fed coefficients.
+    SIMDChain<float> floatChain;
+    SIMDChain<double> doubleChain;
+    
+    // Wraps the chain when "Oversampling" is above 1x. The order comes with the designed coefficients.
+    ChainOversampler<float> floatOversampler;
+    ChainOversampler<double> doubleOversampler;
+    
+    // "Linear Phase": the same curve as a symmetric FIR, convolved instead of the chain above.
+    LinearPhaseDesigner linearPhaseDesigner {apvts};
+    PartitionedConvolver convolver;
+    std::atomic<float>* phaseModeParameter = apvts.getRawParameterValue("Phase Mode");
+    bool linearPhaseActive = false;
+    
+    // Host bypass, or nothing left to do (every band bypassed or neutral): the chain
+    // is skipped and the input only goes through a delay as long as the latency.
+    BypassFader<float> floatBypass;
+    BypassFader<double> doubleBypass;
+    
+    // Fades for the bypass above and for bands switching on and off in the chains.
+    static constexpr double crossfadeTimeSeconds = 0.01;
+    
+    // Sleep: after the input has been digital silence (exact zeros) for longer than the
+    // tail and the output has died down as well, the state is flushed and nothing runs
+    // until the input comes back. Anything quieter but not zero (dither, fade tails)
+    // still gets filtered.
+    std::atomic<double> tailLengthSeconds {0.0};
+    int silentSamples = 0;
+    bool sleeping = false;
+    
+    // Where the output counts as died down: -160 dB, way under a 24 bit LSB (-138 dB).
+    // The chain snaps its own states to zero below the same level.
+    static constexpr float outputSilenceThreshold = 1.0e-8f;
+    
+    // The host is told about a new latency from the message thread (handleAsyncUpdate()).
+    std::atomic<int> pendingLatencySamples {0};
+    
+    // 3rd order ambisonics, more than any bed we EQ (7.1.4 = 12).
+    static constexpr int maxNumChannels = 16;
+    
+    // Coefficients are designed on the shared designer thread, the audio thread only swaps them in.
+    DesignCounter designCounter;
     
-    // Declaramos una función auxiliar. 
-    void UpdatePeakFilter(const ChainSettings& chainSettings);
-    void UpdateLowCut(const ChainSettings& chainSettings);
-    void UpdateHighCut(const ChainSettings& chainSettings);
+   #if EELEQ_PROFILING
+    DspProfiler profiler;
+   #endif
+    
+    // Everything that follows one set of the fixed bands' parameters. The first set runs
+    // every channel in "Stereo" mode, with a split "Channel Mode" it's Left or Mid and
+    // the second one ("Ch2 ...") is Right or Side. The user bands come with the first set.
+    struct ChannelSet
+    {
+        ChannelSet(juce::AudioProcessorValueTreeState& apvts, DesignCounter& counter, int setIndex) :
+        index(setIndex), designer(apvts, counter, setIndex) {}
+        
+        int index;
+        CoefficientDesigner designer;
+        
+        // Parameter ramps. While they move, the ramping bands are redesigned here every "Control Rate" samples.
+        ChainSmoother smoother;
+        ChainCoefficients rampCoefficients;
+        std::array<bool, NumChainPositions> bandRamping {};
+        
+        double tailSeconds = 0.0; // of the designer's latest set, latency not included
+    };
+    
+    std::array<ChannelSet, NumChannelSets> channelSets {{ {apvts, designCounter, 0}, {apvts, designCounter, 1} }};
+    
+    int samplesUntilControlTick = 0;
+    std::atomic<float>* controlRateParameter = apvts.getRawParameterValue("Control Rate");
+    
+    // "Channel Mode" as the chain runs it, always Stereo unless the main bus is a stereo pair
+    // and "Phase Mode" is minimum phase (the linear phase kernel is built from the first set only).
+    std::atomic<float>* channelModeParameter = apvts.getRawParameterValue("Channel Mode");
+    ChannelMode channelMode = ChannelMode::ChannelMode_Stereo;
+    
+    // "Peak Dynamic": detector and gain computer, polled at every control tick.
+    // blockPosition is how far into the host block the chain has got.
+    DynamicPeak dynamicPeak {apvts};
+    int blockPosition = 0;
+    
+    static constexpr double smoothingTimeSeconds = 0.05;
+    
+    template<typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer, SIMDChain<SampleType>& chain,
+                        ChainOversampler<SampleType>& oversampler, BypassFader<SampleType>& bypass,
+                        bool hostBypassed);
+    
+    template<typename SampleType>
+    void processChain(juce::dsp::AudioBlock<SampleType>& block, SIMDChain<SampleType>& chain,
+                      ChainOversampler<SampleType>& oversampler);
+    
+    bool shouldProcess(bool hostBypassed) const;
+    void updateCrossfadeLengths();
+    
+    void updateTailLength();
     
     void UpdateFilters();
+    void UpdateFilters(ChannelSet& channelSet);
+    bool isRamping() const;
+    bool isSmoothing() const;
+    void UpdateSmoothedBands(ChannelSet& channelSet, int position);
+    bool isDynamicPeakRunning() const;
+    
+    // The sets the chain runs: just the first one in "Stereo" mode.
+    int getNumActiveChannelSets() const { return channelMode == ChannelMode::ChannelMode_Stereo ? 1 : NumChannelSets; }
+    ChannelMode getChannelModeForLayout() const;
+    void updateChannelMode();
+    
+    void setChainCoefficients(const ChainCoefficients& chainCoefficients, int channelSet);
+    void setBandCoefficients(const ChainCoefficients& chainCoefficients, ChainPositions band, int channelSet);
+    void setUserBandCoefficients(const ChainCoefficients& chainCoefficients);
+    
+    int getOversamplingOrder() const;
+    void setOversamplingOrder(int order);
+    
+    void UpdateLinearPhase();
+    
+    int getCurrentLatency() const;
+    void reportLatency();
+    void handleAsyncUpdate() override;
     
     //Creamos un Oscilador para calibrar la FFT
     
@@ -0,0 +1,1256 @@
+/*
+  ==============================================================================
+
+    SIMDChain.h
+    Created: 17 Oct 2026 9:48:32am
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <array>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ChainSettings.h"
+#include "BiquadDesign.h"
+#include "CpuDispatch.h"
+#include "DspProfiler.h"
+
+//==============================================================================
+// Section layout of the chain, same order as MonoChain:
+// LowCut x4 -> Peak -> HighCut x4
+// The two parallel form cuts are extra stages that take the place of their
+// cascade sections when CutStructure_Parallel is on.
+// The user bands come after that, MaxCutSections slots each: user band b's
+// section i is stage FirstUserStage + b * MaxCutSections + i.
+
+enum ChainSections
+{
+    LowCutSection = 0,
+    PeakSection = LowCutSection + MaxCutSections,
+    HighCutSection = PeakSection + 1,
+    NumChainSections = HighCutSection + MaxCutSections,
+
+    LowCutParallelStage = NumChainSections,
+    HighCutParallelStage,
+    NumChainStages,
+
+    FirstUserStage = NumChainStages,
+    NumUserSections = MaxUserBands * MaxCutSections
+};
+
+//==============================================================================
+// The whole MonoChain cascade running on any number of channels, one channel
+// per SIMD lane. Channels are taken a register at a time ("lane groups": 4 float
+// channels on SSE/NEON), so a 7.1.4 bed is 3 groups and 3rd order ambisonics 4.
+//
+// Every group is interleaved into a scratch buffer of SIMDRegisters, every active
+// section walks it once for all of the group's channels, and it's de-interleaved
+// back. Coefficients are shared by all channels, the filter states live in one
+// flat array per section (structure of arrays, group after group) sized in prepare().
+//
+// Stage semantics match MonoChain: per-stage bypass, a bypassed section keeps its
+// state frozen. The maths is the same transposed direct form II as
+// juce::dsp::IIR::Filter, operation for operation.
+//
+// Bands that are bypassed or neutral (isBandActive()) aren't run at all, and with
+// none left process() returns straight away. Switching a band on or off crossfades
+// its output with its input over setCrossfadeLength() samples so it doesn't click.
+//
+// A parallel form cut runs sample by sample across all of its sections instead,
+// they're independent so the CPU can keep them all in flight at once. It's always
+// float, so a cut with poles near DC never gets one (usesParallelForm()).
+//
+// The user bands live in one flat store: every coefficient is its own array over
+// all NumUserSections slots, the state is laid out lane group after lane group so
+// a group's sweep through its sections walks it forwards. A band only lists the
+// sections it actually has (1, or 1-4 for a cut), so an inactive band costs a flag
+// check and the work grows with the number of active sections, nothing else.
+//
+// SIMDChain<float> switches single sections to double coefficients and state when
+// their poles sit right next to DC (BiquadCoefficients::hasPolesNearDC()), that's
+// where float runs out of precision. Everything else stays float.
+//
+// With a split "Channel Mode" the fixed bands carry two coefficient sets in the
+// same registers: set 0 (Left or Mid) on the even lanes, set 1 (Right or Side) on
+// the odd ones, so a stereo pair is still one pass. A band that's off in one set
+// but on in the other runs with unity coefficients on that set's lanes. Mid/Side
+// is encoded while interleaving and decoded while de-interleaving, no extra passes.
+//
+// In the common case (cascade cuts, nothing fading, all float) the fixed bands
+// don't go through the stage lists at all: there's a kernel for every
+// (low cut sections, peak on/off, high cut sections) combination, instantiated
+// from one template, that runs all of them in a single pass over the scratch with
+// the states in registers. The one that matches is picked into a function pointer
+// whenever the configuration changes, anything else falls back to the stage lists.
+//
+// On AVX2 / AVX-512 machines the cascades (the fixed kernels and
+// runSection()) hand the loop to CpuDispatch's kernels for that level, picked in
+// prepare(). Those do the same operations in the same order, the output doesn't
+// depend on the level.
+
+template<typename SampleType>
+struct SIMDChain
+{
+    using Vec = juce::dsp::SIMDRegister<SampleType>;
+    using DoubleVec = juce::dsp::SIMDRegister<double>;
+
+    static constexpr int lanesPerGroup = (int)Vec::SIMDNumElements;
+    static constexpr int doubleVecsPerGroup = lanesPerGroup / (int)DoubleVec::SIMDNumElements;
+
+    static constexpr bool isFloat = std::is_same<SampleType, float>::value;
+
+    // Channel sets alternate lanes, in the double registers of a float chain too.
+    static constexpr int AllChannelSets = -1;
+    static_assert(DoubleVec::SIMDNumElements % NumChannelSets == 0, "channel sets need whole lane pairs");
+    static_assert(NumChainSections <= MaxCascadeSections, "the fixed bands must fit a cascade kernel");
+
+    // Allocates the state for spec.numChannels, not realtime safe.
+    void prepare(const juce::dsp::ProcessSpec& spec)
+    {
+        numChannels = juce::jmax(1, (int)spec.numChannels);
+        numGroups = (numChannels + lanesPerGroup - 1) / lanesPerGroup;
+        cpuKernels = &getCpuKernels();
+
+        interleaved.assign((size_t)juce::jmax(1, (int)spec.maximumBlockSize), Vec::expand(0));
+        dry.assign(interleaved.size(), Vec::expand(0));
+
+        for (auto& section : sections)
+        {
+            section.s1.assign((size_t)numGroups, Vec::expand(0));
+            section.s2.assign((size_t)numGroups, Vec::expand(0));
+
+            if (isFloat)
+            {
+                section.doubleS1.assign((size_t)(numGroups * doubleVecsPerGroup), DoubleVec::expand(0));
+                section.doubleS2.assign((size_t)(numGroups * doubleVecsPerGroup), DoubleVec::expand(0));
+            }
+        }
+
+        for (auto& cut : parallelCuts)
+        {
+            cut.s1.assign((size_t)(numGroups * MaxCutSections), Vec::expand(0));
+            cut.s2.assign((size_t)(numGroups * MaxCutSections), Vec::expand(0));
+        }
+
+        user.s1.assign((size_t)(numGroups * NumUserSections), Vec::expand(0));
+        user.s2.assign((size_t)(numGroups * NumUserSections), Vec::expand(0));
+
+        if (isFloat)
+        {
+            user.doubleS1.assign((size_t)(numGroups * NumUserSections * doubleVecsPerGroup), DoubleVec::expand(0));
+            user.doubleS2.assign((size_t)(numGroups * NumUserSections * doubleVecsPerGroup), DoubleVec::expand(0));
+        }
+    }
+
+    void reset()
+    {
+        for (auto& section : sections)
+        {
+            std::fill(section.s1.begin(), section.s1.end(), Vec::expand(0));
+            std::fill(section.s2.begin(), section.s2.end(), Vec::expand(0));
+            std::fill(section.doubleS1.begin(), section.doubleS1.end(), DoubleVec::expand(0));
+            std::fill(section.doubleS2.begin(), section.doubleS2.end(), DoubleVec::expand(0));
+        }
+
+        for (auto& cut : parallelCuts)
+            resetParallelCut(cut);
+
+        std::fill(user.s1.begin(), user.s1.end(), Vec::expand(0));
+        std::fill(user.s2.begin(), user.s2.end(), Vec::expand(0));
+        std::fill(user.doubleS1.begin(), user.doubleS1.end(), DoubleVec::expand(0));
+        std::fill(user.doubleS2.begin(), user.doubleS2.end(), DoubleVec::expand(0));
+
+        // Nothing to fade from.
+        for (auto& band : bands)
+            band.fadeSamplesLeft.fill(0);
+
+        settleBands();
+        selectFixedKernel();
+    }
+
+    // Audio thread. Starts from silence, the owner sets both channel sets' coefficients right after.
+    void setChannelMode(ChannelMode newMode)
+    {
+        if (newMode == channelMode)
+            return;
+
+        channelMode = newMode;
+        reset();
+    }
+
+    ChannelMode getChannelMode() const { return channelMode; }
+
+    int getNumChannels() const { return numChannels; }
+
+    // In samples at the rate the chain runs at. 0 switches bands instantly.
+    void setCrossfadeLength(int numSamples)
+    {
+        crossfadeLength = juce::jmax(0, numSamples);
+
+        for (auto& band : bands)
+            for (auto& fade : band.fadeSamplesLeft)
+                fade = juce::jmin(fade, crossfadeLength);
+
+        settleBands();
+        selectFixedKernel();
+    }
+
+   #if EELEQ_PROFILING
+    // Stage timings go here, null for none. Not while process() runs.
+    void setProfiler(DspProfiler* newProfiler)
+    {
+        profiler = newProfiler;
+        selectFixedKernel(); // EELEQ_PROFILING_PER_BAND
+    }
+   #endif
+
+    // No band running (or fading out), the chain leaves the signal alone.
+    bool isTransparent() const
+    {
+        for (int band = 0; band < NumBands; ++band)
+            if (isRunning(band))
+                return false;
+
+        return true;
+    }
+
+    //==============================================================================
+    // Called from the audio thread, no allocation.
+
+    void setChainCoefficients(const ChainCoefficients& chainCoefficients)
+    {
+        setBandCoefficients(chainCoefficients, ChainPositions::LowCut);
+        setBandCoefficients(chainCoefficients, ChainPositions::Peak);
+        setBandCoefficients(chainCoefficients, ChainPositions::HighCut);
+        setUserBandCoefficients(chainCoefficients);
+    }
+
+    // Only the fixed bands of one channel set, for the split channel modes.
+    void setChannelSetCoefficients(const ChainCoefficients& chainCoefficients, int channelSet)
+    {
+        setBandCoefficients(chainCoefficients, ChainPositions::LowCut, channelSet);
+        setBandCoefficients(chainCoefficients, ChainPositions::Peak, channelSet);
+        setBandCoefficients(chainCoefficients, ChainPositions::HighCut, channelSet);
+    }
+
+    // Every user band at once. Bands past "Band Count" (or inactive) fade out like the fixed ones.
+    void setUserBandCoefficients(const ChainCoefficients& chainCoefficients)
+    {
+        const auto& chainSettings = chainCoefficients.settings;
+
+        for (int index = 0; index < MaxUserBands; ++index)
+        {
+            auto band = FirstUserBand + index;
+            auto on = isUserBandActive(chainSettings, index);
+
+            if (on)
+            {
+                auto& b = bands[(size_t)band];
+                const auto& c = chainCoefficients.userBands[(size_t)index];
+                auto firstSection = index * MaxCutSections;
+
+                if (!isRunning(band))
+                {
+                    resetUserSections(firstSection, MaxCutSections);
+                    b.numStages = 0;
+                }
+
+                // A steeper slope adds sections, they start from silence.
+                if (c.numSections > b.numStages)
+                    resetUserSections(firstSection + b.numStages, c.numSections - b.numStages);
+
+                b.numStages = c.numSections;
+
+                for (int i = 0; i < c.numSections; ++i)
+                {
+                    setUserSectionCoefficients(firstSection + i, c.sections[(size_t)i]);
+                    b.stages[(size_t)i] = FirstUserStage + firstSection + i;
+                }
+            }
+
+            setBandOn(band, on, AllChannelSets);
+        }
+    }
+
+    // channelSet is 0 or 1 in the split modes, AllChannelSets otherwise.
+    void setBandCoefficients(const ChainCoefficients& chainCoefficients, ChainPositions band,
+                             int channelSet = AllChannelSets)
+    {
+        const auto& chainSettings = chainCoefficients.settings;
+        auto on = isBandActive(chainSettings, band);
+
+        // Switched off: keep running on the old coefficients until it has faded out.
+        if (on)
+        {
+            // Coming back from silence: whatever state it froze with is long stale.
+            if (!isRunning(band))
+                resetBand(band);
+
+            switch (band)
+            {
+                case ChainPositions::LowCut:
+                    setCutCoefficients(LowCutSection, LowCutParallelStage, chainCoefficients.lowCut,
+                                       chainSettings, chainSettings.lowCutSlope, channelSet);
+                    break;
+
+                case ChainPositions::Peak:
+                    setSectionCoefficients(PeakSection, chainCoefficients.peak, channelSet);
+                    active[PeakSection] = true;
+                    break;
+
+                case ChainPositions::HighCut:
+                    setCutCoefficients(HighCutSection, HighCutParallelStage, chainCoefficients.highCut,
+                                       chainSettings, chainSettings.highCutSlope, channelSet);
+                    break;
+            }
+        }
+
+        setBandOn(band, on, channelSet);
+        updateActiveSections();
+        settleBands();
+        selectFixedKernel();
+    }
+
+    //==============================================================================
+
+    template<typename ProcessContext>
+    void process(const ProcessContext& context)
+    {
+        auto& outputBlock = context.getOutputBlock();
+        const auto& inputBlock = context.getInputBlock();
+
+        // More channels than we were prepared for? Those pass through untouched.
+        jassert((int)outputBlock.getNumChannels() <= numChannels);
+
+        auto numBlockChannels = juce::jmin((int)outputBlock.getNumChannels(), numChannels);
+        auto numSamples = (int)outputBlock.getNumSamples();
+
+        if (context.isBypassed || isTransparent())
+        {
+            if (context.usesSeparateInputAndOutputBlocks())
+                outputBlock.copyFrom(inputBlock);
+
+            return;
+        }
+
+        auto capacity = (int)interleaved.size();
+
+        // The host shouldn't send more than maximumBlockSize, but chunk it just in case.
+        for (int start = 0; start < numSamples; start += capacity)
+        {
+            auto length = juce::jmin(capacity, numSamples - start);
+
+            for (int group = 0; group * lanesPerGroup < numBlockChannels; ++group)
+            {
+                auto firstChannel = group * lanesPerGroup;
+                auto numGroupChannels = juce::jmin(lanesPerGroup, numBlockChannels - firstChannel);
+
+                interleave(inputBlock, firstChannel, numGroupChannels, start, length);
+
+                if (fixedKernel != nullptr)
+                {
+                    EELEQ_PROFILE(profiler, ProfilerStage_FixedBands);
+                    (this->*fixedKernel)(group, length);
+                }
+                else
+                {
+                    for (int band = 0; band < FirstUserBand; ++band)
+                        processBand(band, group, length);
+                }
+
+                {
+                    EELEQ_PROFILE(profiler, ProfilerStage_UserBands);
+
+                    for (int band = FirstUserBand; band < NumBands; ++band)
+                        processBand(band, group, length);
+                }
+
+                deinterleave(outputBlock, firstChannel, numGroupChannels, start, length);
+            }
+
+            // Every group faded over the same samples, move on together.
+            auto fadeEnded = false;
+
+            for (auto& band : bands)
+            {
+                for (auto& fade : band.fadeSamplesLeft)
+                {
+                    fadeEnded = fadeEnded || (fade > 0 && fade <= length);
+                    fade = juce::jmax(0, fade - length);
+                }
+            }
+
+            if (fadeEnded)
+            {
+                settleBands();
+                selectFixedKernel();
+            }
+        }
+    }
+
+private:
+    struct Section
+    {
+        Vec b0 = Vec::expand(1), b1 = Vec::expand(0), b2 = Vec::expand(0),
+            a1 = Vec::expand(0), a2 = Vec::expand(0);
+
+        std::vector<Vec> s1, s2; // one per lane group
+
+        // Float chains only, for sections with poles near DC (in either channel set).
+        bool highPrecision = false;
+        std::array<bool, NumChannelSets> nearDC {};
+        DoubleVec doubleB0, doubleB1, doubleB2, doubleA1, doubleA2;
+        std::vector<DoubleVec> doubleS1, doubleS2; // doubleVecsPerGroup per lane group
+    };
+
+    struct ParallelCut
+    {
+        Vec direct = Vec::expand(1);
+        std::array<Vec, MaxCutSections> b0, b1, a1, a2;
+        std::vector<Vec> s1, s2; // MaxCutSections per lane group
+        int numSections = 0;
+    };
+
+    // Structure of arrays, index = user band * MaxCutSections + section.
+    struct UserSections
+    {
+        std::array<Vec, NumUserSections> b0, b1, b2, a1, a2;
+
+        std::vector<Vec> s1, s2; // [group * NumUserSections + section]
+
+        // Float chains only, same as Section.
+        std::array<bool, NumUserSections> highPrecision {};
+        std::array<DoubleVec, NumUserSections> doubleB0, doubleB1, doubleB2, doubleA1, doubleA2;
+        std::vector<DoubleVec> doubleS1, doubleS2; // doubleVecsPerGroup per s1/s2 entry
+    };
+
+    struct Band
+    {
+        // Per channel set, both the same outside the split modes.
+        std::array<bool, NumChannelSets> on {};
+        std::array<int, NumChannelSets> fadeSamplesLeft {}; // towards 'on'
+
+        std::array<int, MaxCutSections + 1> stages {}; // in processing order
+        int numStages = 0;
+
+        bool isOn() const { return on[0] || on[1]; }
+        bool isFading() const { return fadeSamplesLeft[0] > 0 || fadeSamplesLeft[1] > 0; }
+    };
+
+    // LowCut, Peak, HighCut (the ChainPositions), then the user bands.
+    static constexpr int FirstUserBand = NumChainPositions;
+    static constexpr int NumBands = FirstUserBand + MaxUserBands;
+
+    int numChannels = 0, numGroups = 0;
+
+    std::array<Section, NumChainSections> sections;
+    std::array<ParallelCut, 2> parallelCuts; // LowCut, HighCut
+    UserSections user;
+
+    std::array<bool, NumChainStages> active {}; // by either channel set
+    std::array<std::array<bool, NumChainSections>, NumChannelSets> usedBySet {};
+    std::array<Band, NumBands> bands;
+
+    ChannelMode channelMode = ChannelMode::ChannelMode_Stereo;
+    int crossfadeLength = 0;
+
+    using FixedKernel = void (SIMDChain::*)(int group, int numSamples);
+    FixedKernel fixedKernel = nullptr; // null: the fixed bands go through processBand()
+
+    const CpuKernels* cpuKernels = nullptr;
+
+   #if EELEQ_PROFILING
+    DspProfiler* profiler = nullptr;
+   #endif
+
+    std::vector<Vec> interleaved; // one Vec per sample, one lane per channel of the current group
+    std::vector<Vec> dry;         // a fading band's input
+
+    //==============================================================================
+
+    SampleType* getInterleavedData() { return reinterpret_cast<SampleType*>(interleaved.data()); }
+
+    // Null when the SIMDRegister loops are as good as it gets on this CPU.
+    CascadeKernel<SampleType> getCascadeKernel(int numSections) const
+    {
+        return cpuKernels != nullptr ? cpuKernels->getCascade<SampleType>(numSections) : nullptr;
+    }
+
+    static BiquadLanes<SampleType> getLanes(const Vec& b0, const Vec& b1, const Vec& b2, const Vec& a1, const Vec& a2,
+                                            Vec& s1, Vec& s2)
+    {
+        auto lanes = [](const Vec& v) { return reinterpret_cast<const SampleType*>(&v); };
+
+        return { lanes(b0), lanes(b1), lanes(b2), lanes(a1), lanes(a2),
+                 reinterpret_cast<SampleType*>(&s1), reinterpret_cast<SampleType*>(&s2) };
+    }
+
+    template<typename Function>
+    static void forEachChannelSet(int channelSet, Function&& function)
+    {
+        for (int set = 0; set < NumChannelSets; ++set)
+            if (channelSet == AllChannelSets || channelSet == set)
+                function(set);
+    }
+
+    // Writes 'value' into the lanes of one channel set (every lane for AllChannelSets).
+    template<typename VecType, typename ValueType>
+    static void setLanes(VecType& v, ValueType value, int channelSet)
+    {
+        using ElementType = typename VecType::ElementType;
+
+        if (channelSet == AllChannelSets)
+        {
+            v = VecType::expand(static_cast<ElementType>(value));
+            return;
+        }
+
+        for (auto lane = (size_t)channelSet; lane < VecType::SIMDNumElements; lane += NumChannelSets)
+            v.set(lane, static_cast<ElementType>(value));
+    }
+
+    void setSectionCoefficients(int index, const BiquadCoefficients& c, int channelSet = AllChannelSets)
+    {
+        auto& section = sections[index];
+
+        setLanes(section.b0, c.b0, channelSet);
+        setLanes(section.b1, c.b1, channelSet);
+        setLanes(section.b2, c.b2, channelSet);
+        setLanes(section.a1, c.a1, channelSet);
+        setLanes(section.a2, c.a2, channelSet);
+
+        if (isFloat)
+        {
+            forEachChannelSet(channelSet, [&section, &c](int set) { section.nearDC[(size_t)set] = c.hasPolesNearDC(); });
+
+            auto highPrecision = section.nearDC[0] || section.nearDC[1];
+
+            // Crossing the threshold mid-sweep: carry the state over so it doesn't click.
+            if (highPrecision != section.highPrecision)
+                for (size_t group = 0; group < section.s1.size(); ++group)
+                    transferState(section.s1[group], section.s2[group],
+                                  section.doubleS1.data() + group * doubleVecsPerGroup,
+                                  section.doubleS2.data() + group * doubleVecsPerGroup, highPrecision);
+
+            section.highPrecision = highPrecision;
+
+            setLanes(section.doubleB0, c.b0, channelSet);
+            setLanes(section.doubleB1, c.b1, channelSet);
+            setLanes(section.doubleB2, c.b2, channelSet);
+            setLanes(section.doubleA1, c.a1, channelSet);
+            setLanes(section.doubleA2, c.a2, channelSet);
+        }
+    }
+
+    void resetSection(int index, int channelSet)
+    {
+        auto& section = sections[index];
+
+        for (auto& v : section.s1) setLanes(v, 0, channelSet);
+        for (auto& v : section.s2) setLanes(v, 0, channelSet);
+        for (auto& v : section.doubleS1) setLanes(v, 0, channelSet);
+        for (auto& v : section.doubleS2) setLanes(v, 0, channelSet);
+    }
+
+    void setUserSectionCoefficients(int index, const BiquadCoefficients& c)
+    {
+        user.b0[(size_t)index] = Vec::expand(static_cast<SampleType>(c.b0));
+        user.b1[(size_t)index] = Vec::expand(static_cast<SampleType>(c.b1));
+        user.b2[(size_t)index] = Vec::expand(static_cast<SampleType>(c.b2));
+        user.a1[(size_t)index] = Vec::expand(static_cast<SampleType>(c.a1));
+        user.a2[(size_t)index] = Vec::expand(static_cast<SampleType>(c.a2));
+
+        if (isFloat)
+        {
+            auto highPrecision = c.hasPolesNearDC();
+
+            if (highPrecision != user.highPrecision[(size_t)index])
+            {
+                for (int group = 0; group < numGroups; ++group)
+                {
+                    auto state = (size_t)(group * NumUserSections + index);
+
+                    transferState(user.s1[state], user.s2[state],
+                                  user.doubleS1.data() + state * doubleVecsPerGroup,
+                                  user.doubleS2.data() + state * doubleVecsPerGroup, highPrecision);
+                }
+            }
+
+            user.highPrecision[(size_t)index] = highPrecision;
+
+            user.doubleB0[(size_t)index] = DoubleVec::expand(c.b0);
+            user.doubleB1[(size_t)index] = DoubleVec::expand(c.b1);
+            user.doubleB2[(size_t)index] = DoubleVec::expand(c.b2);
+            user.doubleA1[(size_t)index] = DoubleVec::expand(c.a1);
+            user.doubleA2[(size_t)index] = DoubleVec::expand(c.a2);
+        }
+    }
+
+    void resetUserSections(int firstSection, int numSections)
+    {
+        for (int group = 0; group < numGroups; ++group)
+        {
+            for (int i = firstSection; i < firstSection + numSections; ++i)
+            {
+                auto state = (size_t)(group * NumUserSections + i);
+
+                user.s1[state] = Vec::expand(0);
+                user.s2[state] = Vec::expand(0);
+
+                if (isFloat)
+                {
+                    for (int j = 0; j < doubleVecsPerGroup; ++j)
+                    {
+                        user.doubleS1[state * doubleVecsPerGroup + (size_t)j] = DoubleVec::expand(0);
+                        user.doubleS2[state * doubleVecsPerGroup + (size_t)j] = DoubleVec::expand(0);
+                    }
+                }
+            }
+        }
+    }
+
+    // One lane group's state between float and its doubleVecsPerGroup double registers.
+    static void transferState(Vec& s1, Vec& s2, DoubleVec* doubleS1, DoubleVec* doubleS2, bool toDouble)
+    {
+        auto transfer = [toDouble](Vec& v, DoubleVec* doubles)
+        {
+            for (int j = 0; j < doubleVecsPerGroup; ++j)
+            {
+                for (int lane = 0; lane < (int)DoubleVec::SIMDNumElements; ++lane)
+                {
+                    auto index = (size_t)(j * (int)DoubleVec::SIMDNumElements + lane);
+
+                    if (toDouble)
+                        doubles[j].set((size_t)lane, (double)v.get(index));
+                    else
+                        v.set(index, static_cast<SampleType>(doubles[j].get((size_t)lane)));
+                }
+            }
+        };
+
+        transfer(s1, doubleS1);
+        transfer(s2, doubleS2);
+    }
+
+    void setCutCoefficients(int firstSection, int parallelStage, const CutCoefficients& cut,
+                            const ChainSettings& chainSettings, Slope slope, int channelSet)
+    {
+        auto numSections = getNumCutSections(slope);
+
+        // The parallel form has one direct path for every lane, so it needs both sets on the same cut.
+        auto parallel = channelMode == ChannelMode::ChannelMode_Stereo && usesParallelForm(chainSettings, cut);
+
+        for (int i = 0; i < MaxCutSections; ++i)
+        {
+            auto index = firstSection + i;
+            auto used = !parallel && i < numSections;
+
+            // A section a set starts or stops using starts from silence on its lanes. One
+            // the other set still runs gets unity coefficients on this set's lanes.
+            forEachChannelSet(channelSet, [this, index, used](int set)
+            {
+                if (usedBySet[(size_t)set][(size_t)index] != used)
+                    resetSection(index, set);
+
+                usedBySet[(size_t)set][(size_t)index] = used;
+            });
+
+            setSectionCoefficients(index, used ? cut.sections[i] : BiquadCoefficients(), channelSet);
+            active[index] = usedBySet[0][(size_t)index] || usedBySet[1][(size_t)index];
+        }
+
+        auto& parallelCut = getParallelCut(parallelStage);
+
+        if (parallel)
+        {
+            // Switching structure: the cascade state means nothing to the parallel sections.
+            if (!active[parallelStage] || parallelCut.numSections != cut.parallel.numSections)
+                resetParallelCut(parallelCut);
+
+            setParallelCoefficients(parallelCut, cut.parallel);
+        }
+
+        active[parallelStage] = parallel;
+    }
+
+    bool isRunning(int band) const
+    {
+        return bands[(size_t)band].isOn() || bands[(size_t)band].isFading();
+    }
+
+    void setBandOn(int band, bool on, int channelSet)
+    {
+        auto& b = bands[(size_t)band];
+
+        forEachChannelSet(channelSet, [this, &b, on](int set)
+        {
+            auto& fade = b.fadeSamplesLeft[(size_t)set];
+
+            if (b.on[(size_t)set] == on)
+                return;
+
+            b.on[(size_t)set] = on;
+
+            // Turned around mid-fade: go back from where it is.
+            fade = fade > 0 ? crossfadeLength - fade : crossfadeLength;
+        });
+    }
+
+    // A fixed band that has faded out of one channel set while the other still runs
+    // it: unity on that set's lanes, so it can run without the crossfade.
+    void settleBands()
+    {
+        for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+        {
+            const auto& b = bands[band];
+
+            if (!b.isOn())
+                continue;
+
+            for (int set = 0; set < NumChannelSets; ++set)
+            {
+                if (b.on[(size_t)set] || b.fadeSamplesLeft[(size_t)set] > 0)
+                    continue;
+
+                for (int i = 0; i < b.numStages; ++i)
+                {
+                    auto stage = b.stages[(size_t)i];
+
+                    if (stage < NumChainSections)
+                    {
+                        setSectionCoefficients(stage, BiquadCoefficients(), set);
+                        resetSection(stage, set);
+                    }
+                }
+            }
+        }
+    }
+
+    // Cascade sections first, then the parallel stage (only one of the two is ever active).
+    void updateActiveSections()
+    {
+        auto collect = [this](Band& band, int firstSection, int numSections, int parallelStage)
+        {
+            band.numStages = 0;
+
+            for (int i = firstSection; i < firstSection + numSections; ++i)
+                if (active[i])
+                    band.stages[(size_t)band.numStages++] = i;
+
+            if (parallelStage >= 0 && active[parallelStage])
+                band.stages[(size_t)band.numStages++] = parallelStage;
+        };
+
+        collect(bands[ChainPositions::LowCut], LowCutSection, MaxCutSections, LowCutParallelStage);
+        collect(bands[ChainPositions::Peak], PeakSection, 1, -1);
+        collect(bands[ChainPositions::HighCut], HighCutSection, MaxCutSections, HighCutParallelStage);
+    }
+
+    //==============================================================================
+    // Fixed band kernels, indexed by (low cut sections * 2 + peak) * (MaxCutSections + 1) + high cut sections.
+
+    static constexpr int NumFixedKernels = (MaxCutSections + 1) * 2 * (MaxCutSections + 1);
+
+    template<int... Index>
+    static constexpr std::array<FixedKernel, sizeof...(Index)> makeFixedKernels(std::integer_sequence<int, Index...>)
+    {
+        return { &SIMDChain::processFixedBands<Index / (2 * (MaxCutSections + 1)),
+                                               (Index / (MaxCutSections + 1)) % 2 == 1,
+                                               Index % (MaxCutSections + 1)>... };
+    }
+
+    void selectFixedKernel()
+    {
+        static constexpr auto kernels = makeFixedKernels(std::make_integer_sequence<int, NumFixedKernels> {});
+
+        fixedKernel = nullptr;
+
+       #if EELEQ_PROFILING && EELEQ_PROFILING_PER_BAND
+        // Per band timings asked for, processBand() it is.
+        if (profiler != nullptr)
+            return;
+       #endif
+
+        std::array<int, NumChainPositions> numSections {};
+
+        for (auto band : { ChainPositions::LowCut, ChainPositions::Peak, ChainPositions::HighCut })
+        {
+            const auto& b = bands[band];
+
+            if (b.isFading())
+                return;
+
+            if (!b.isOn())
+                continue;
+
+            for (int i = 0; i < b.numStages; ++i)
+            {
+                auto stage = b.stages[(size_t)i];
+
+                // Parallel cuts and double sections keep their own loops.
+                if (stage >= NumChainSections || (isFloat && sections[stage].highPrecision))
+                    return;
+            }
+
+            numSections[band] = b.numStages;
+        }
+
+        auto index = (numSections[ChainPositions::LowCut] * 2 + numSections[ChainPositions::Peak])
+                   * (MaxCutSections + 1) + numSections[ChainPositions::HighCut];
+
+        fixedKernel = kernels[(size_t)index];
+    }
+
+    // Low cut -> peak -> high cut, every section one after the other on each sample.
+    // The counts are template arguments so the section loop unrolls completely.
+    template<int NumLowCut, bool HasPeak, int NumHighCut>
+    void processFixedBands(int group, int numSamples)
+    {
+        constexpr int numSections = NumLowCut + (HasPeak ? 1 : 0) + NumHighCut;
+
+        if constexpr (numSections > 0)
+        {
+            std::array<Section*, numSections> used {};
+            int n = 0;
+
+            for (int i = 0; i < NumLowCut; ++i)
+                used[(size_t)n++] = &sections[LowCutSection + i];
+
+            if (HasPeak)
+                used[(size_t)n++] = &sections[PeakSection];
+
+            for (int i = 0; i < NumHighCut; ++i)
+                used[(size_t)n++] = &sections[HighCutSection + i];
+
+            if (auto kernel = getCascadeKernel(numSections))
+            {
+                std::array<BiquadLanes<SampleType>, numSections> lanes;
+
+                for (int k = 0; k < numSections; ++k)
+                {
+                    auto& section = *used[(size_t)k];
+                    lanes[(size_t)k] = getLanes(section.b0, section.b1, section.b2, section.a1, section.a2,
+                                                section.s1[(size_t)group], section.s2[(size_t)group]);
+                }
+
+                kernel(getInterleavedData(), numSamples, lanes.data());
+                return;
+            }
+
+            std::array<Vec, numSections> b0, b1, b2, a1, a2, s1, s2;
+
+            for (int k = 0; k < numSections; ++k)
+            {
+                const auto& section = *used[(size_t)k];
+
+                b0[k] = section.b0; b1[k] = section.b1; b2[k] = section.b2;
+                a1[k] = section.a1; a2[k] = section.a2;
+                s1[k] = section.s1[(size_t)group]; s2[k] = section.s2[(size_t)group];
+            }
+
+            auto* data = getInterleavedData();
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto* frame = data + i * lanesPerGroup;
+                auto x = Vec::fromRawArray(frame);
+
+                for (int k = 0; k < numSections; ++k)
+                {
+                    auto y = (x * b0[k]) + s1[k];
+
+                    s1[k] = (x * b1[k]) - (y * a1[k]) + s2[k];
+                    s2[k] = (x * b2[k]) - (y * a2[k]);
+
+                    x = y;
+                }
+
+                x.copyToRawArray(frame);
+            }
+
+            for (int k = 0; k < numSections; ++k)
+            {
+                used[(size_t)k]->s1[(size_t)group] = snapToZero(s1[k]);
+                used[(size_t)k]->s2[(size_t)group] = snapToZero(s2[k]);
+            }
+        }
+        else
+        {
+            juce::ignoreUnused(group, numSamples);
+        }
+    }
+
+    void resetBand(ChainPositions band)
+    {
+        auto resetSections = [this](int firstSection, int numSections)
+        {
+            for (int i = firstSection; i < firstSection + numSections; ++i)
+            {
+                auto& section = sections[i];
+
+                std::fill(section.s1.begin(), section.s1.end(), Vec::expand(0));
+                std::fill(section.s2.begin(), section.s2.end(), Vec::expand(0));
+                std::fill(section.doubleS1.begin(), section.doubleS1.end(), DoubleVec::expand(0));
+                std::fill(section.doubleS2.begin(), section.doubleS2.end(), DoubleVec::expand(0));
+            }
+        };
+
+        switch (band)
+        {
+            case ChainPositions::LowCut:
+                resetSections(LowCutSection, MaxCutSections);
+                resetParallelCut(getParallelCut(LowCutParallelStage));
+                break;
+
+            case ChainPositions::Peak:
+                resetSections(PeakSection, 1);
+                break;
+
+            case ChainPositions::HighCut:
+                resetSections(HighCutSection, MaxCutSections);
+                resetParallelCut(getParallelCut(HighCutParallelStage));
+                break;
+        }
+    }
+
+    ParallelCut& getParallelCut(int stage) { return parallelCuts[(size_t)(stage - LowCutParallelStage)]; }
+
+    void setParallelCoefficients(ParallelCut& cut, const ParallelCutCoefficients& c)
+    {
+        cut.numSections = c.numSections;
+        cut.direct = Vec::expand(static_cast<SampleType>(c.direct));
+
+        for (int i = 0; i < c.numSections; ++i)
+        {
+            cut.b0[i] = Vec::expand(static_cast<SampleType>(c.sections[i].b0));
+            cut.b1[i] = Vec::expand(static_cast<SampleType>(c.sections[i].b1));
+            cut.a1[i] = Vec::expand(static_cast<SampleType>(c.sections[i].a1));
+            cut.a2[i] = Vec::expand(static_cast<SampleType>(c.sections[i].a2));
+        }
+    }
+
+    static void resetParallelCut(ParallelCut& cut)
+    {
+        std::fill(cut.s1.begin(), cut.s1.end(), Vec::expand(0));
+        std::fill(cut.s2.begin(), cut.s2.end(), Vec::expand(0));
+    }
+
+    //==============================================================================
+
+    template<typename BlockType>
+    void interleave(const BlockType& block, int firstChannel, int numGroupChannels, int start, int length)
+    {
+        auto* data = getInterleavedData();
+
+        for (int ch = 0; ch < numGroupChannels; ++ch)
+        {
+            auto* src = block.getChannelPointer((size_t)(firstChannel + ch)) + start;
+
+            for (int i = 0; i < length; ++i)
+                data[i * lanesPerGroup + ch] = src[i];
+        }
+
+        // Partial last group: keep the unused lanes silent, whatever the previous group left there.
+        for (int ch = numGroupChannels; ch < lanesPerGroup; ++ch)
+            for (int i = 0; i < length; ++i)
+                data[i * lanesPerGroup + ch] = 0;
+
+        // Left/Right in lanes 0/1 become Mid/Side, deinterleave() turns them back.
+        if (isMidSideGroup(firstChannel, numGroupChannels))
+        {
+            for (int i = 0; i < length; ++i)
+            {
+                auto* frame = data + i * lanesPerGroup;
+                auto left = frame[0], right = frame[1];
+
+                frame[0] = (SampleType)0.5 * (left + right);
+                frame[1] = (SampleType)0.5 * (left - right);
+            }
+        }
+    }
+
+    template<typename BlockType>
+    void deinterleave(BlockType& block, int firstChannel, int numGroupChannels, int start, int length)
+    {
+        auto* data = getInterleavedData();
+
+        if (isMidSideGroup(firstChannel, numGroupChannels))
+        {
+            auto* left = block.getChannelPointer(0) + start;
+            auto* right = block.getChannelPointer(1) + start;
+
+            for (int i = 0; i < length; ++i)
+            {
+                auto mid = data[i * lanesPerGroup], side = data[i * lanesPerGroup + 1];
+
+                left[i] = mid + side;
+                right[i] = mid - side;
+            }
+
+            // Anything past the pair is plain.
+            firstChannel += 2;
+            numGroupChannels -= 2;
+            data += 2;
+        }
+
+        for (int ch = 0; ch < numGroupChannels; ++ch)
+        {
+            auto* dst = block.getChannelPointer((size_t)(firstChannel + ch)) + start;
+
+            for (int i = 0; i < length; ++i)
+                dst[i] = data[i * lanesPerGroup + ch];
+        }
+    }
+
+    bool isMidSideGroup(int firstChannel, int numGroupChannels) const
+    {
+        return channelMode == ChannelMode::ChannelMode_MidSide && firstChannel == 0 && numGroupChannels >= 2;
+    }
+
+    void processBand(int band, int group, int numSamples)
+    {
+        if (!isRunning(band))
+            return;
+
+        // The fixed bands are timed one by one here, the user bands all together by process().
+        EELEQ_PROFILE(band < FirstUserBand ? profiler : nullptr,
+                      (ProfilerStage)(ProfilerStage_LowCut + juce::jmin(band, FirstUserBand - 1)));
+
+        const auto& b = bands[(size_t)band];
+        auto fading = b.isFading();
+
+        if (fading)
+            std::copy(interleaved.begin(), interleaved.begin() + numSamples, dry.begin());
+
+        for (int i = 0; i < b.numStages; ++i)
+            processStage(b.stages[(size_t)i], group, numSamples);
+
+        if (fading)
+            crossfade(b, numSamples);
+    }
+
+    // Linear fade between the band's input (dry) and output. Each channel set has its
+    // own ramp on its lanes, a set that isn't fading sits at fully on or off.
+    void crossfade(const Band& band, int numSamples)
+    {
+        auto length = (SampleType)crossfadeLength;
+        std::array<SampleType, NumChannelSets> position;
+
+        for (size_t set = 0; set < NumChannelSets; ++set)
+            position[set] = (SampleType)(crossfadeLength - band.fadeSamplesLeft[set]);
+
+        auto gain = Vec::expand(0);
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int set = 0; set < NumChannelSets; ++set)
+            {
+                auto progress = juce::jmin((SampleType)1, (position[(size_t)set] + (SampleType)i) / length);
+                setLanes(gain, band.on[(size_t)set] ? progress : (SampleType)1 - progress, set);
+            }
+
+            interleaved[(size_t)i] = dry[(size_t)i] + (interleaved[(size_t)i] - dry[(size_t)i]) * gain;
+        }
+    }
+
+    void processStage(int stage, int group, int numSamples)
+    {
+        if (stage < NumChainSections)
+        {
+            processSection(sections[stage], group, numSamples);
+            return;
+        }
+
+        if (stage >= FirstUserStage)
+        {
+            processUserSection(stage - FirstUserStage, group, numSamples);
+            return;
+        }
+
+        auto& cut = getParallelCut(stage);
+
+        // Fixed section counts so the inner loop unrolls and the states stay in registers.
+        switch (cut.numSections)
+        {
+            case 2: processParallelCut<2>(cut, group, numSamples); break;
+            case 3: processParallelCut<3>(cut, group, numSamples); break;
+            case 4: processParallelCut<4>(cut, group, numSamples); break;
+            default: jassertfalse; break;
+        }
+    }
+
+    void processSection(Section& section, int group, int numSamples)
+    {
+        if (isFloat && section.highPrecision)
+        {
+            runSectionInDouble(section.doubleB0, section.doubleB1, section.doubleB2, section.doubleA1, section.doubleA2,
+                               section.doubleS1.data() + group * doubleVecsPerGroup,
+                               section.doubleS2.data() + group * doubleVecsPerGroup, numSamples);
+            return;
+        }
+
+        runSection(section.b0, section.b1, section.b2, section.a1, section.a2,
+                   section.s1[(size_t)group], section.s2[(size_t)group], numSamples);
+    }
+
+    void processUserSection(int index, int group, int numSamples)
+    {
+        auto i = (size_t)index;
+        auto state = (size_t)(group * NumUserSections + index);
+
+        if (isFloat && user.highPrecision[i])
+        {
+            runSectionInDouble(user.doubleB0[i], user.doubleB1[i], user.doubleB2[i], user.doubleA1[i], user.doubleA2[i],
+                               user.doubleS1.data() + state * doubleVecsPerGroup,
+                               user.doubleS2.data() + state * doubleVecsPerGroup, numSamples);
+            return;
+        }
+
+        runSection(user.b0[i], user.b1[i], user.b2[i], user.a1[i], user.a2[i],
+                   user.s1[state], user.s2[state], numSamples);
+    }
+
+    // One biquad over the interleaved scratch, the state of one lane group.
+    void runSection(Vec b0, Vec b1, Vec b2, Vec a1, Vec a2, Vec& state1, Vec& state2, int numSamples)
+    {
+        if (auto kernel = getCascadeKernel(1))
+        {
+            auto lanes = getLanes(b0, b1, b2, a1, a2, state1, state2);
+            kernel(getInterleavedData(), numSamples, &lanes);
+            return;
+        }
+
+        auto* data = getInterleavedData();
+        auto s1 = state1, s2 = state2;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto* frame = data + i * lanesPerGroup;
+
+            auto input = Vec::fromRawArray(frame);
+            auto output = (input * b0) + s1;
+
+            s1 = (input * b1) - (output * a1) + s2;
+            s2 = (input * b2) - (output * a2);
+
+            output.copyToRawArray(frame);
+        }
+
+        // Same denormal guard IIR::Filter applies to its state at the end of every block.
+        state1 = snapToZero(s1);
+        state2 = snapToZero(s2);
+    }
+
+    // Same TDF2, with the float lanes widened into doubleVecsPerGroup double registers per sample.
+    void runSectionInDouble(DoubleVec b0, DoubleVec b1, DoubleVec b2, DoubleVec a1, DoubleVec a2,
+                            DoubleVec* groupS1, DoubleVec* groupS2, int numSamples)
+    {
+        auto* data = getInterleavedData();
+
+        std::array<DoubleVec, doubleVecsPerGroup> s1, s2;
+
+        for (int j = 0; j < doubleVecsPerGroup; ++j)
+        {
+            s1[j] = groupS1[j];
+            s2[j] = groupS2[j];
+        }
+
+        constexpr int doubleLanes = (int)DoubleVec::SIMDNumElements;
+        alignas(DoubleVec::SIMDRegisterSize) double widened[doubleLanes];
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto* frame = data + i * lanesPerGroup;
+
+            for (int j = 0; j < doubleVecsPerGroup; ++j)
+            {
+                auto* lanes = frame + j * doubleLanes;
+
+                for (int lane = 0; lane < doubleLanes; ++lane)
+                    widened[lane] = (double)lanes[lane];
+
+                auto input = DoubleVec::fromRawArray(widened);
+                auto output = (input * b0) + s1[j];
+
+                s1[j] = (input * b1) - (output * a1) + s2[j];
+                s2[j] = (input * b2) - (output * a2);
+
+                output.copyToRawArray(widened);
+
+                for (int lane = 0; lane < doubleLanes; ++lane)
+                    lanes[lane] = static_cast<SampleType>(widened[lane]);
+            }
+        }
+
+        for (int j = 0; j < doubleVecsPerGroup; ++j)
+        {
+            groupS1[j] = snapToZero(s1[j]);
+            groupS2[j] = snapToZero(s2[j]);
+        }
+    }
+
+    template<int NumSections>
+    void processParallelCut(ParallelCut& cut, int group, int numSamples)
+    {
+        auto* data = getInterleavedData();
+        auto* groupS1 = cut.s1.data() + group * MaxCutSections;
+        auto* groupS2 = cut.s2.data() + group * MaxCutSections;
+
+        auto direct = cut.direct;
+        std::array<Vec, NumSections> b0, b1, a1, a2, s1, s2;
+
+        for (int k = 0; k < NumSections; ++k)
+        {
+            b0[k] = cut.b0[k]; b1[k] = cut.b1[k];
+            a1[k] = cut.a1[k]; a2[k] = cut.a2[k];
+            s1[k] = groupS1[k]; s2[k] = groupS2[k];
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto* frame = data + i * lanesPerGroup;
+
+            auto input = Vec::fromRawArray(frame);
+            auto output = input * direct;
+
+            // b2 is zero in the parallel sections.
+            for (int k = 0; k < NumSections; ++k)
+            {
+                auto y = (input * b0[k]) + s1[k];
+
+                s1[k] = (input * b1[k]) - (y * a1[k]) + s2[k];
+                s2[k] = Vec::expand(0) - (y * a2[k]);
+
+                output += y;
+            }
+
+            output.copyToRawArray(frame);
+        }
+
+        for (int k = 0; k < NumSections; ++k)
+        {
+            groupS1[k] = snapToZero(s1[k]);
+            groupS2[k] = snapToZero(s2[k]);
+        }
+    }
+
+    template<typename VecType>
+    static VecType snapToZero(VecType v)
+    {
+       #if JUCE_INTEL
+        using ElementType = typename VecType::ElementType;
+        auto threshold = static_cast<ElementType>(1.0e-8);
+
+        return v & (VecType::greaterThan(v, VecType::expand(threshold))
+                    | VecType::lessThan(v, VecType::expand(-threshold)));
+       #else
+        return v;
+       #endif
+    }
+};
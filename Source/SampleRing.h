@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+    SampleRing.h
+    Created: 18 Oct 2026 3:12:26am
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <algorithm>
+#include <atomic>
+#include <type_traits>
+#include <vector>
+
+//==============================================================================
+// Lock-free ring of float samples from one writer thread to one reader thread
+// (audio thread -> analyzer), any number of channels moving in lockstep.
+//
+// The capacity is a power of two and the positions are free running counters,
+// masked on access, so "how much is there" is one subtraction. Each side owns
+// its own position on its own cache line, the other one only ever reads it.
+// The channels share the positions, so they can't drift apart: a write or read
+// is at most two copies per channel, one when it wraps around the end.
+//
+// The writer never waits: a block that doesn't fit (reader too far behind, or
+// no reader at all) is dropped whole, the reader can skip() to catch up.
+//
+// The size is fixed at construction, so nothing the reader looks at outside the
+// two positions ever changes while it's running.
+
+struct SampleRing
+{
+    // Rounds the capacity up to a power of two.
+    SampleRing(int numChannelsToUse, int minimumCapacity) :
+    numChannels(juce::jmax(1, numChannelsToUse)),
+    capacity((juce::uint32)juce::nextPowerOfTwo(juce::jmax(1, minimumCapacity))),
+    mask(capacity - 1),
+    buffer((size_t)numChannels * capacity, 0.f)
+    {
+    }
+
+    // Empties it. Nobody may be reading or writing.
+    void reset()
+    {
+        writePosition.store(0);
+        readPosition.store(0);
+    }
+
+    int getCapacity() const { return (int)capacity; }
+    int getNumChannels() const { return numChannels; }
+
+    //Writer side...
+    // One source per channel. False if it didn't fit, nothing is written then.
+    template<typename SampleType>
+    bool write(const SampleType* const* sources, int numSamples)
+    {
+        auto write = writePosition.load(std::memory_order_relaxed);
+        auto read = readPosition.load(std::memory_order_acquire);
+
+        if (numSamples <= 0)
+            return true;
+
+        if ((juce::uint32)numSamples > capacity - (write - read))
+            return false;
+
+        auto start = write & mask;
+        auto first = juce::jmin((juce::uint32)numSamples, capacity - start);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* channel = getChannel(ch);
+
+            copy(channel + start, sources[ch], (int)first);
+            copy(channel, sources[ch] + first, numSamples - (int)first);
+        }
+
+        writePosition.store(write + (juce::uint32)numSamples, std::memory_order_release);
+        return true;
+    }
+
+    //Reader side...
+    int getNumReady() const
+    {
+        return (int)(writePosition.load(std::memory_order_acquire) - readPosition.load(std::memory_order_relaxed));
+    }
+
+    // One destination per channel. All numSamples or nothing (false).
+    bool read(float* const* destinations, int numSamples)
+    {
+        auto read = readPosition.load(std::memory_order_relaxed);
+        auto write = writePosition.load(std::memory_order_acquire);
+
+        if (numSamples <= 0)
+            return true;
+
+        if ((juce::uint32)numSamples > write - read)
+            return false;
+
+        auto start = read & mask;
+        auto first = juce::jmin((juce::uint32)numSamples, capacity - start);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto* channel = getChannel(ch);
+
+            copy(destinations[ch], channel + start, (int)first);
+            copy(destinations[ch] + first, channel, numSamples - (int)first);
+        }
+
+        readPosition.store(read + (juce::uint32)numSamples, std::memory_order_release);
+        return true;
+    }
+
+    // Drops up to numSamples of the oldest ones.
+    void skip(int numSamples)
+    {
+        auto read = readPosition.load(std::memory_order_relaxed);
+        auto numToSkip = (juce::uint32)juce::jlimit(0, getNumReady(), numSamples);
+
+        readPosition.store(read + numToSkip, std::memory_order_release);
+    }
+
+private:
+    float* getChannel(int channel) { return buffer.data() + (size_t)channel * capacity; }
+
+    // Float to float is a plain memcpy, double host buffers get converted on the way in.
+    template<typename SampleType>
+    static void copy(float* destination, const SampleType* source, int numSamples)
+    {
+        if constexpr (std::is_same<SampleType, float>::value)
+            juce::FloatVectorOperations::copy(destination, source, numSamples);
+        else
+            std::transform(source, source + numSamples, destination, [](SampleType x) { return (float)x; });
+    }
+
+    const int numChannels;
+    const juce::uint32 capacity, mask;
+    std::vector<float> buffer; // channel after channel, capacity each
+
+    // Apart, so the two threads don't keep stealing each other's cache line.
+    // (alignas pads the struct out to the line after it too.)
+    alignas(64) std::atomic<juce::uint32> writePosition {0};
+    alignas(64) std::atomic<juce::uint32> readPosition {0};
+};
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+    Created: 16 Oct 2026 2:58:03pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+//==============================================================================
+// Lock-free triple buffer for handing complete objects from one writer thread
+// to one reader thread (designer thread -> audio thread).
+//
+// The writer fills getWriteBuffer() and calls publish(); the reader calls acquire()
+// and, if it returns true, reads getReadBuffer(). Each side only ever touches its
+// own slot, the hand-off is a single atomic exchange of the "middle" slot index,
+// so neither side can block or allocate.
+
+template<typename T>
+struct TripleBuffer
+{
+    //Writer side...
+    T& getWriteBuffer() { return buffers[writeIndex]; }
+
+    void publish()
+    {
+        auto previous = middle.exchange(writeIndex | freshFlag, std::memory_order_acq_rel);
+        writeIndex = previous & indexMask;
+    }
+
+    //Reader side...
+    // Returns true if a newer object was published since the last call.
+    bool acquire()
+    {
+        if ((middle.load(std::memory_order_relaxed) & freshFlag) == 0)
+            return false;
+
+        auto previous = middle.exchange(readIndex, std::memory_order_acq_rel);
+        readIndex = previous & indexMask;
+        return true;
+    }
+
+    const T& getReadBuffer() const { return buffers[readIndex]; }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshFlag = 4;
+
+    std::array<T, 3> buffers;
+    std::atomic<int> middle {1};
+    int writeIndex = 0;
+    int readIndex = 2;
+};
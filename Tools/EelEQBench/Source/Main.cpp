@@ -0,0 +1,607 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 10:58:02pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include <limits>
+#include <map>
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/PluginEditor.h"
+
+//==============================================================================
+// Benchmarks, JSON out, optionally checked against a stored baseline.
+//
+//   EelEQBench [--out=results.json] [--baseline=baseline.json] [--tolerance=0.1]
+//              [--filter=text] [--seconds=0.25] [--quick] [--double]
+//              [--cpu=baseline|sse4.1|avx2|avx512]
+//
+// processBlock/...  ns per stereo sample frame over block sizes 1 - 4096,
+//                   44.1 - 384 kHz, cut slope pairs and the three bypass states:
+//                   every band running, every band neutral (the dry fast path) and
+//                   host bypass (processBlockBypassed()).
+// design/...        ns per call of the coefficient design functions.
+// response/...      ns per response curve, the editor's per pixel magnitude loop.
+// fft/...           ns per produceFFTDataForRendering() call, per analyzer FFT order
+//                   and view (L/R, M/S, sum).
+//
+// --cpu runs the kernels of a lower instruction set than the CPU has (CpuDispatch),
+// the level ends up in the JSON next to the CPU model.
+//
+// Every case runs a few times and keeps the fastest run, that's the least noisy
+// number on a shared machine. With --baseline a case slower than baseline * (1 +
+// tolerance) is a regression, they get listed and the exit code is 2.
+
+namespace
+{
+    struct Options
+    {
+        juce::File outputFile, baselineFile;
+        double tolerance = 0.1;
+        juce::String filter;
+        double secondsPerRun = 0.25;
+        bool quick = false;
+        bool doublePrecision = false;
+    };
+
+    struct Result
+    {
+        juce::String name, unit;
+        double value;
+    };
+
+    constexpr int numRuns = 5;
+
+    // Fastest of numRuns, in ns per 'numItems' items. 'run' does one complete run.
+    template<typename Function>
+    double timeRuns(double numItems, Function&& run)
+    {
+        auto best = std::numeric_limits<double>::max();
+
+        for (int i = 0; i < numRuns; ++i)
+        {
+            auto start = juce::Time::getHighResolutionTicks();
+            run();
+            auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+
+            best = juce::jmin(best, seconds);
+        }
+
+        return best * 1.0e9 / numItems;
+    }
+
+    // The compiler mustn't throw away what we time.
+    volatile double sink = 0.0;
+
+    //==============================================================================
+
+    enum class BypassState { Active, Neutral, Host };
+
+    const char* getName(BypassState state)
+    {
+        switch (state)
+        {
+            case BypassState::Active:  return "active";
+            case BypassState::Neutral: return "neutral";
+            case BypassState::Host:    return "host-bypassed";
+        }
+
+        return "";
+    }
+
+    struct ProcessBlockBench
+    {
+        explicit ProcessBlockBench(const Options& o) : options(o)
+        {
+            if (options.doublePrecision)
+                processor.setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+        }
+
+        double run(double sampleRate, int blockSize, Slope lowCutSlope, Slope highCutSlope, BypassState state)
+        {
+            auto active = state != BypassState::Neutral;
+
+            setParameter("LowCut Freq", 100.f);
+            setParameter("HighCut Freq", 8000.f);
+            setParameter("LowCut Slope", (float)lowCutSlope);
+            setParameter("HighCut Slope", (float)highCutSlope);
+            setParameter("Peak Freq", 1000.f);
+            setParameter("Peak Gain", 4.f);
+            setParameter("LowCut Bypassed", active ? 0.f : 1.f);
+            setParameter("HighCut Bypassed", active ? 0.f : 1.f);
+            setParameter("Peak Bypassed", active ? 0.f : 1.f);
+
+            // Designs everything from the parameters right here, nothing arrives later.
+            processor.setRateAndBufferSizeDetails(sampleRate, blockSize);
+            processor.prepareToPlay(sampleRate, blockSize);
+
+            auto numBlocks = juce::jmax(1, juce::roundToInt(options.secondsPerRun * sampleRate / blockSize));
+            auto hostBypassed = state == BypassState::Host;
+
+            auto nsPerSample = options.doublePrecision ? time(doubleBuffer, blockSize, numBlocks, hostBypassed)
+                                                       : time(floatBuffer, blockSize, numBlocks, hostBypassed);
+
+            processor.releaseResources();
+            return nsPerSample;
+        }
+
+    private:
+        EelEQAudioProcessor processor;
+        const Options& options;
+
+        juce::AudioBuffer<float> floatBuffer;
+        juce::AudioBuffer<double> doubleBuffer;
+        juce::MidiBuffer midi;
+
+        void setParameter(const juce::String& id, float value)
+        {
+            auto* parameter = processor.apvts.getParameter(id);
+            jassert(parameter != nullptr);
+
+            parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+        }
+
+        // Noise, so the processor never goes to sleep.
+        template<typename SampleType>
+        double time(juce::AudioBuffer<SampleType>& buffer, int blockSize, int numBlocks, bool hostBypassed)
+        {
+            buffer.setSize(2, blockSize);
+            juce::Random random(1);
+
+            auto fill = [&]
+            {
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < blockSize; ++i)
+                        buffer.setSample(ch, i, (SampleType)(random.nextFloat() * 0.5f - 0.25f));
+            };
+
+            auto process = [&]
+            {
+                if (hostBypassed)
+                    processor.processBlockBypassed(buffer, midi);
+                else
+                    processor.processBlock(buffer, midi);
+            };
+
+            // Warm up (and get any bypass fade out of the way).
+            for (int i = 0; i < juce::jmax(8, 8192 / blockSize); ++i)
+            {
+                fill();
+                process();
+            }
+
+            // Refilled every time, the output would drift off towards silence or denormals otherwise.
+            // The fill is outside the timed part.
+            double totalSeconds = std::numeric_limits<double>::max();
+
+            for (int run = 0; run < numRuns; ++run)
+            {
+                juce::int64 ticks = 0;
+
+                for (int i = 0; i < numBlocks; ++i)
+                {
+                    fill();
+
+                    auto start = juce::Time::getHighResolutionTicks();
+                    process();
+                    ticks += juce::Time::getHighResolutionTicks() - start;
+                }
+
+                totalSeconds = juce::jmin(totalSeconds, juce::Time::highResolutionTicksToSeconds(ticks));
+            }
+
+            sink = sink + (double)buffer.getSample(0, 0);
+
+            return totalSeconds * 1.0e9 / ((double)numBlocks * blockSize);
+        }
+    };
+
+    //==============================================================================
+
+    struct Bench
+    {
+        explicit Bench(const Options& o) : options(o) {}
+
+        void runAll()
+        {
+            runProcessBlock();
+            runDesign();
+            runResponse();
+            runFFT();
+        }
+
+        const std::vector<Result>& getResults() const { return results; }
+
+    private:
+        const Options& options;
+        std::vector<Result> results;
+
+        bool wants(const juce::String& name) const
+        {
+            return options.filter.isEmpty() || name.contains(options.filter);
+        }
+
+        void add(const juce::String& name, const juce::String& unit, double value)
+        {
+            results.push_back({ name, unit, value });
+            std::cout << name << ": " << juce::String(value, 2) << " " << unit << std::endl;
+        }
+
+        void runProcessBlock()
+        {
+            std::vector<int> blockSizes { 1, 32, 64, 256, 1024, 4096 };
+            std::vector<double> sampleRates { 44100.0, 48000.0, 96000.0, 192000.0, 384000.0 };
+            std::vector<std::pair<Slope, Slope>> slopes { { Slope_12, Slope_12 }, { Slope_24, Slope_24 },
+                                                          { Slope_36, Slope_36 }, { Slope_48, Slope_48 },
+                                                          { Slope_12, Slope_48 } };
+
+            if (options.quick)
+            {
+                blockSizes = { 64, 512 };
+                sampleRates = { 48000.0, 192000.0 };
+                slopes = { { Slope_12, Slope_12 }, { Slope_48, Slope_48 } };
+            }
+
+            ProcessBlockBench bench(options);
+            auto precision = options.doublePrecision ? "double" : "float";
+
+            auto runCase = [&](double sampleRate, int blockSize, std::pair<Slope, Slope> slope, BypassState state)
+            {
+                auto name = juce::String("processBlock/") + precision + "/" + juce::String(juce::roundToInt(sampleRate))
+                          + "/" + juce::String(blockSize) + "/" + getName(state);
+
+                if (state == BypassState::Active)
+                    name << "/" << (12 + 12 * (int)slope.first) << "-" << (12 + 12 * (int)slope.second);
+
+                if (wants(name))
+                    add(name, "ns/sample", bench.run(sampleRate, blockSize, slope.first, slope.second, state));
+            };
+
+            for (auto sampleRate : sampleRates)
+            {
+                for (auto blockSize : blockSizes)
+                {
+                    for (auto slope : slopes)
+                        runCase(sampleRate, blockSize, slope, BypassState::Active);
+
+                    // The slopes don't matter for these two.
+                    runCase(sampleRate, blockSize, slopes.front(), BypassState::Neutral);
+                    runCase(sampleRate, blockSize, slopes.front(), BypassState::Host);
+                }
+            }
+        }
+
+        void runDesign()
+        {
+            constexpr int numCalls = 10000;
+            constexpr double sampleRate = 48000.0;
+
+            ChainSettings settings;
+            settings.peakQuality = 1.f;
+            settings.peakGainInDecibels = 4.f;
+            settings.lowCutSlope = settings.highCutSlope = Slope_48;
+
+            // Moving frequencies, like a ramp.
+            auto frequency = [](int i) { return 50.f + (float)(i % 1000) * 15.f; };
+
+            if (wants("design/makePeakFilter"))
+                add("design/makePeakFilter", "ns/call", timeRuns(numCalls, [&]
+                {
+                    for (int i = 0; i < numCalls; ++i)
+                    {
+                        settings.peakFreq = frequency(i);
+                        sink = sink + makePeakFilter(settings, sampleRate).b0;
+                    }
+                }));
+
+            if (wants("design/makePeakFilter/matched"))
+            {
+                auto matched = settings;
+                matched.peakDesign = PeakDesign_Matched;
+
+                add("design/makePeakFilter/matched", "ns/call", timeRuns(numCalls, [&]
+                {
+                    for (int i = 0; i < numCalls; ++i)
+                    {
+                        matched.peakFreq = frequency(i);
+                        sink = sink + makePeakFilter(matched, sampleRate).b0;
+                    }
+                }));
+            }
+
+            if (wants("design/makeLowCutFilter"))
+                add("design/makeLowCutFilter", "ns/call", timeRuns(numCalls, [&]
+                {
+                    for (int i = 0; i < numCalls; ++i)
+                    {
+                        settings.lowCutFreq = frequency(i);
+                        sink = sink + makeLowCutFilter(settings, sampleRate).sections[0].b0;
+                    }
+                }));
+
+            if (wants("design/makeHighCutFilter"))
+                add("design/makeHighCutFilter", "ns/call", timeRuns(numCalls, [&]
+                {
+                    for (int i = 0; i < numCalls; ++i)
+                    {
+                        settings.highCutFreq = frequency(i);
+                        sink = sink + makeHighCutFilter(settings, sampleRate).sections[0].b0;
+                    }
+                }));
+        }
+
+        // What ResponseCurveComponent::updateResponseCurve() does per repaint, one magnitude per pixel.
+        void runResponse()
+        {
+            constexpr int width = 600;
+            constexpr int numCurves = 200;
+            constexpr double sampleRate = 48000.0;
+
+            ChainSettings settings;
+            settings.lowCutFreq = 100.f;
+            settings.highCutFreq = 8000.f;
+            settings.peakFreq = 1000.f;
+            settings.peakGainInDecibels = 4.f;
+            settings.peakQuality = 1.f;
+            settings.lowCutSlope = settings.highCutSlope = Slope_48;
+
+            auto coefficients = makeChainCoefficients(settings, sampleRate);
+
+            MonoChain monoChain;
+            prepareBiquads(monoChain);
+            UpdateChainCoefficients(monoChain, coefficients);
+
+            if (wants("response/monoChain"))
+                add("response/monoChain", "ns/curve", timeRuns(numCurves, [&]
+                {
+                    auto& lowcut = monoChain.get<ChainPositions::LowCut>();
+                    auto& peak = monoChain.get<ChainPositions::Peak>();
+                    auto& highcut = monoChain.get<ChainPositions::HighCut>();
+
+                    for (int curve = 0; curve < numCurves; ++curve)
+                    {
+                        for (int i = 0; i < width; ++i)
+                        {
+                            auto freq = juce::mapToLog10(double(i) / double(width), 20.0, 20000.0);
+                            double mag = peak.coefficients->getMagnitudeForFrequency(freq, sampleRate);
+
+                            mag *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+                            mag *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+                            mag *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+                            mag *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+                            mag *= highcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+                            mag *= highcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+                            mag *= highcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+                            mag *= highcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
+
+                            sink = sink + juce::Decibels::gainToDecibels(mag);
+                        }
+                    }
+                }));
+
+            // The same curve from the designed coefficients, no juce::dsp objects.
+            if (wants("response/chainCoefficients"))
+                add("response/chainCoefficients", "ns/curve", timeRuns(numCurves, [&]
+                {
+                    for (int curve = 0; curve < numCurves; ++curve)
+                    {
+                        for (int i = 0; i < width; ++i)
+                        {
+                            auto freq = juce::mapToLog10(double(i) / double(width), 20.0, 20000.0);
+                            sink = sink + juce::Decibels::gainToDecibels(getChainMagnitudeForFrequency(coefficients, freq));
+                        }
+                    }
+                }));
+        }
+
+        void runFFT()
+        {
+            const std::pair<AnalyzerView, const char*> views[] { { AnalyzerView_LeftRight, "lr" },
+                                                                 { AnalyzerView_MidSide, "ms" },
+                                                                 { AnalyzerView_Sum, "sum" } };
+
+            for (auto order : { FFTOrder::order2048, FFTOrder::order4096, FFTOrder::order8192, FFTOrder::order16384 })
+            {
+                for (const auto& [view, viewName] : views)
+                {
+                    auto name = "fft/produceFFTDataForRendering/" + juce::String(1 << (int)order) + "/" + viewName;
+
+                    if (!wants(name))
+                        continue;
+
+                    FFTDataGenerator<std::vector<float>> generator;
+                    generator.changeOrder(order);
+
+                    // Both channels, the way StereoSampleFifo hands them over.
+                    juce::AudioBuffer<float> buffer(2, generator.getFFTSize());
+                    juce::Random random(1);
+
+                    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                        for (int i = 0; i < buffer.getNumSamples(); ++i)
+                            buffer.setSample(ch, i, random.nextFloat() * 2.f - 1.f);
+
+                    std::vector<float> fftData;
+                    constexpr int numCalls = 200;
+
+                    // Drained after every call like the editor does, a full fifo would skip the copy.
+                    add(name, "ns/call", timeRuns(numCalls, [&, view = view]
+                    {
+                        for (int i = 0; i < numCalls; ++i)
+                        {
+                            generator.produceFFTDataForRendering(buffer, view, -48.f);
+
+                            while (generator.getFFTData(fftData)) {}
+                        }
+                    }));
+                }
+            }
+        }
+    };
+
+    //==============================================================================
+
+    juce::var toJSON(const std::vector<Result>& results, const Options& options)
+    {
+        juce::Array<juce::var> list;
+
+        for (const auto& result : results)
+        {
+            auto* entry = new juce::DynamicObject();
+            entry->setProperty("name", result.name);
+            entry->setProperty("unit", result.unit);
+            entry->setProperty("value", result.value);
+            list.add(juce::var(entry));
+        }
+
+        auto* root = new juce::DynamicObject();
+        root->setProperty("version", 1);
+        root->setProperty("date", juce::Time::getCurrentTime().toISO8601(true));
+        root->setProperty("os", juce::SystemStats::getOperatingSystemName());
+        root->setProperty("cpu", juce::SystemStats::getCpuModel());
+        root->setProperty("cpuLevel", getCpuLevelName(getCpuLevel()));
+        root->setProperty("precision", options.doublePrecision ? "double" : "float");
+        root->setProperty("results", list);
+
+        return juce::var(root);
+    }
+
+    // Returns the number of regressions. Cases missing on either side are listed, not counted.
+    int compareWithBaseline(const std::vector<Result>& results, const juce::var& baseline, double tolerance)
+    {
+        std::map<juce::String, double> baselineValues;
+
+        if (auto* list = baseline["results"].getArray())
+            for (const auto& entry : *list)
+                baselineValues[entry["name"].toString()] = (double)entry["value"];
+
+        int numRegressions = 0;
+
+        for (const auto& result : results)
+        {
+            auto it = baselineValues.find(result.name);
+
+            if (it == baselineValues.end())
+            {
+                std::cout << "new: " << result.name << std::endl;
+                continue;
+            }
+
+            auto ratio = result.value / juce::jmax(1.0e-12, it->second);
+
+            if (ratio > 1.0 + tolerance)
+            {
+                std::cout << "REGRESSION " << result.name << ": " << juce::String(it->second, 2) << " -> "
+                          << juce::String(result.value, 2) << " " << result.unit
+                          << " (+" << juce::String((ratio - 1.0) * 100.0, 1) << "%)" << std::endl;
+                ++numRegressions;
+            }
+            else if (ratio < 1.0 - tolerance)
+            {
+                std::cout << "faster " << result.name << ": " << juce::String(it->second, 2) << " -> "
+                          << juce::String(result.value, 2) << " " << result.unit << std::endl;
+            }
+        }
+
+        return numRegressions;
+    }
+
+    bool parseOptions(const juce::ArgumentList& args, Options& options)
+    {
+        for (const auto& arg : args.arguments)
+        {
+            auto text = arg.text;
+            auto name = text.upToFirstOccurrenceOf("=", false, false);
+            auto value = text.fromFirstOccurrenceOf("=", false, false).unquoted();
+
+            if (name == "--out")             options.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+            else if (name == "--baseline")   options.baselineFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+            else if (name == "--tolerance")  options.tolerance = juce::jmax(0.0, value.getDoubleValue());
+            else if (name == "--filter")     options.filter = value;
+            else if (name == "--seconds")    options.secondsPerRun = juce::jlimit(0.001, 60.0, value.getDoubleValue());
+            else if (name == "--quick")      options.quick = true;
+            else if (name == "--double")     options.doublePrecision = true;
+            else if (name == "--cpu")
+            {
+                // Kernels for a lower instruction set than the CPU has, to compare the paths.
+                CpuLevel level;
+
+                if (!parseCpuLevel(value, level) || level > getDetectedCpuLevel())
+                {
+                    std::cerr << "can't run " << value << " kernels here, this CPU does up to "
+                              << getCpuLevelName(getDetectedCpuLevel()) << std::endl;
+                    return false;
+                }
+
+                setCpuLevel(level);
+            }
+            else
+            {
+                std::cerr << "unknown option " << text << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // The processor expects a message manager (parameter listeners, async updates), it never has to run.
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    Options options;
+
+    if (!parseOptions(juce::ArgumentList(argc, argv), options))
+    {
+        std::cerr << "usage: EelEQBench [--out=results.json] [--baseline=baseline.json] [--tolerance=0.1]"
+                     " [--filter=text] [--seconds=0.25] [--quick] [--double] [--cpu=baseline|sse4.1|avx2|avx512]" << std::endl;
+        return 1;
+    }
+
+    Bench bench(options);
+    bench.runAll();
+
+    auto json = toJSON(bench.getResults(), options);
+
+    if (options.outputFile != juce::File())
+    {
+        if (!options.outputFile.replaceWithText(juce::JSON::toString(json)))
+        {
+            std::cerr << "can't write " << options.outputFile.getFullPathName() << std::endl;
+            return 1;
+        }
+    }
+    else
+    {
+        std::cout << juce::JSON::toString(json) << std::endl;
+    }
+
+    if (options.baselineFile != juce::File())
+    {
+        auto baseline = juce::JSON::parse(options.baselineFile);
+
+        if (!baseline.isObject())
+        {
+            std::cerr << "can't read baseline " << options.baselineFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        auto numRegressions = compareWithBaseline(bench.getResults(), baseline, options.tolerance);
+
+        if (numRegressions > 0)
+        {
+            std::cout << numRegressions << " regressions over " << juce::String(options.tolerance * 100.0, 0) << "%" << std::endl;
+            return 2;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,459 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 9:41:18pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <iostream>
+#include "../../../Source/PluginProcessor.h"
+
+//==============================================================================
+// Offline batch renderer: runs audio files through EelEQAudioProcessor with a
+// preset, no host involved.
+//
+//   EelEQRender --preset=<file> --out=<dir> [--format=wav|aiff|flac] [--threads=N]
+//               [--block=N] [--double] [--cpu=baseline|sse4.1|avx2|avx512] <files...>
+//
+// The preset is the plugin state as getStateInformation() writes it (the apvts
+// ValueTree, binary), or the same tree as XML. Every file goes through the same
+// processBlock() calls a host would make, in --block sized buffers (512 by default),
+// so the result is what the plugin gives you. The plugin's latency is compensated,
+// the output is as long as the input.
+//
+// Files are spread over a thread pool, one processor per thread. WAV and AIFF are
+// read through memory mapped readers, FLAC through the normal one, in large chunks
+// either way. Throughput is reported as realtime multiples per core, counting only
+// the time spent in processBlock().
+//
+// The chain comes out the same bits on every CpuDispatch level, so a render node
+// matches the workstation the preset was made on. --cpu pins the level anyway
+// (like EELEQ_CPU), to check exactly that.
+
+namespace
+{
+    constexpr int readChunkSize = 1 << 16;
+
+    struct Options
+    {
+        juce::File presetFile, outputDirectory;
+        juce::String outputFormat; // extension, empty = same as the input
+        int numThreads = juce::SystemStats::getNumCpus();
+        int blockSize = 512;
+        bool doublePrecision = false;
+        juce::Array<juce::File> inputFiles;
+    };
+
+    struct Result
+    {
+        juce::String error;
+        double audioSeconds = 0.0;
+        double processSeconds = 0.0;
+    };
+
+    // Same name in --out, with the --format extension if there is one.
+    juce::File getOutputFile(const Options& options, const juce::File& input)
+    {
+        auto output = options.outputDirectory.getChildFile(input.getFileName());
+
+        if (options.outputFormat.isNotEmpty())
+            output = output.withFileExtension(options.outputFormat);
+
+        return output;
+    }
+
+    //==============================================================================
+    // One per pool thread. Owns a processor with the preset loaded, prepared again for every file.
+
+    struct Renderer
+    {
+        Renderer(const juce::MemoryBlock& preset, const Options& o) : options(o)
+        {
+            processor.setStateInformation(preset.getData(), (int)preset.getSize());
+            processor.setNonRealtime(true);
+
+            if (options.doublePrecision)
+                processor.setProcessingPrecision(juce::AudioProcessor::doublePrecision);
+        }
+
+        Result render(const juce::File& input, juce::AudioFormatManager& formatManager)
+        {
+            Result result;
+
+            // Memory mapped where the format can do it (WAV, AIFF).
+            std::unique_ptr<juce::AudioFormatReader> reader;
+            std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(formatManager.createMemoryMappedReader(input));
+
+            if (mapped != nullptr && mapped->mapEntireFile())
+                reader = std::move(mapped);
+            else
+                reader.reset(formatManager.createReaderFor(input));
+
+            if (reader == nullptr)
+                return fail(result, "can't read " + input.getFullPathName());
+
+            auto numChannels = (int)reader->numChannels;
+            auto sampleRate = reader->sampleRate;
+            auto length = (juce::int64)reader->lengthInSamples;
+
+            if (!setLayout(numChannels))
+                return fail(result, input.getFileName() + ": " + juce::String(numChannels) + " channels isn't supported");
+
+            auto output = getOutputFile(options, input);
+            auto writer = createWriter(output, formatManager, *reader);
+
+            if (writer == nullptr)
+                return fail(result, "can't write " + output.getFullPathName());
+
+            processor.setRateAndBufferSizeDetails(sampleRate, options.blockSize);
+            processor.prepareToPlay(sampleRate, options.blockSize);
+
+            auto latency = (juce::int64)processor.getLatencySamples();
+            juce::int64 ticks = 0;
+
+            // Run 'latency' samples of silence past the end, and drop as many from the start.
+            juce::AudioBuffer<float> chunk(numChannels, readChunkSize);
+            juce::AudioBuffer<double> doubleChunk(options.doublePrecision ? numChannels : 0,
+                                                  options.doublePrecision ? readChunkSize : 0);
+            juce::MidiBuffer midi;
+
+            for (juce::int64 position = 0; position < length + latency; position += readChunkSize)
+            {
+                auto chunkLength = (int)juce::jmin((juce::int64)readChunkSize, length + latency - position);
+                auto numToRead = (int)juce::jlimit((juce::int64)0, (juce::int64)chunkLength, length - position);
+
+                chunk.clear();
+
+                if (numToRead > 0)
+                    reader->read(&chunk, 0, numToRead, position, true, true);
+
+                if (options.doublePrecision)
+                {
+                    for (int ch = 0; ch < numChannels; ++ch)
+                        for (int i = 0; i < chunkLength; ++i)
+                            doubleChunk.setSample(ch, i, (double)chunk.getSample(ch, i));
+
+                    ticks += processChunk(doubleChunk, chunkLength, midi);
+
+                    for (int ch = 0; ch < numChannels; ++ch)
+                        for (int i = 0; i < chunkLength; ++i)
+                            chunk.setSample(ch, i, (float)doubleChunk.getSample(ch, i));
+                }
+                else
+                {
+                    ticks += processChunk(chunk, chunkLength, midi);
+                }
+
+                // Skip what's still inside the latency, stop at the input's length.
+                auto skip = (int)juce::jlimit((juce::int64)0, (juce::int64)chunkLength, latency - position);
+                auto numToWrite = (int)juce::jmin((juce::int64)(chunkLength - skip), length - (position + skip - latency));
+
+                if (numToWrite > 0 && !writer->writeFromAudioSampleBuffer(chunk, skip, numToWrite))
+                    return fail(result, "write failed: " + output.getFullPathName());
+            }
+
+            processor.releaseResources();
+
+            result.audioSeconds = (double)length / sampleRate;
+            result.processSeconds = juce::Time::highResolutionTicksToSeconds(ticks);
+
+            return result;
+        }
+
+    private:
+        EelEQAudioProcessor processor;
+        const Options& options;
+
+        static Result fail(Result& result, const juce::String& error)
+        {
+            result.error = error;
+            return result;
+        }
+
+        // Main bus as wide as the file, no sidechain.
+        bool setLayout(int numChannels)
+        {
+            auto set = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+
+            juce::AudioProcessor::BusesLayout layout;
+            layout.inputBuses.add(set);
+            layout.inputBuses.add(juce::AudioChannelSet::disabled());
+            layout.outputBuses.add(set);
+
+            return processor.setBusesLayout(layout);
+        }
+
+        std::unique_ptr<juce::AudioFormatWriter> createWriter(const juce::File& output, juce::AudioFormatManager& formatManager,
+                                                              const juce::AudioFormatReader& reader)
+        {
+            auto* format = formatManager.findFormatForFileExtension(output.getFileExtension());
+
+            if (format == nullptr)
+                return {};
+
+            // The input's bit depth if the format has it (FLAC has no float), its deepest otherwise.
+            auto depths = format->getPossibleBitDepths();
+            auto bitsPerSample = depths.contains((int)reader.bitsPerSample) ? (int)reader.bitsPerSample : depths.getLast();
+
+            output.deleteFile();
+            std::unique_ptr<juce::OutputStream> stream(output.createOutputStream());
+
+            if (stream == nullptr)
+                return {};
+
+            std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), reader.sampleRate,
+                                                                                    reader.numChannels, bitsPerSample,
+                                                                                    reader.metadataValues, 0));
+
+            // The writer owns the stream from here on.
+            if (writer != nullptr)
+                stream.release();
+
+            return writer;
+        }
+
+        // Host sized buffers over the chunk, the same calls a host makes. Returns the ticks it took.
+        template<typename SampleType>
+        juce::int64 processChunk(juce::AudioBuffer<SampleType>& buffer, int numSamples, juce::MidiBuffer& midi)
+        {
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            for (int start = 0; start < numSamples; start += options.blockSize)
+            {
+                juce::AudioBuffer<SampleType> block(buffer.getArrayOfWritePointers(), buffer.getNumChannels(),
+                                                    start, juce::jmin(options.blockSize, numSamples - start));
+
+                processor.processBlock(block, midi);
+            }
+
+            return juce::Time::getHighResolutionTicks() - startTicks;
+        }
+
+        JUCE_DECLARE_NON_COPYABLE(Renderer)
+    };
+
+    //==============================================================================
+    // Takes a free renderer for the job's file and gives it back afterwards.
+
+    struct RenderPool
+    {
+        RenderPool(const juce::MemoryBlock& preset, const Options& options)
+        {
+            // Built here on the message thread, the preset goes through replaceState().
+            for (int i = 0; i < options.numThreads; ++i)
+                free.add(new Renderer(preset, options));
+
+            all.addArray(free);
+        }
+
+        ~RenderPool()
+        {
+            for (auto* renderer : all)
+                delete renderer;
+        }
+
+        Renderer* take()
+        {
+            const juce::ScopedLock sl(lock);
+            return free.removeAndReturn(free.size() - 1);
+        }
+
+        void giveBack(Renderer* renderer)
+        {
+            const juce::ScopedLock sl(lock);
+            free.add(renderer);
+        }
+
+    private:
+        juce::CriticalSection lock;
+        juce::Array<Renderer*> free, all;
+    };
+
+    struct RenderJob : juce::ThreadPoolJob
+    {
+        RenderJob(const juce::File& f, RenderPool& p, juce::AudioFormatManager& fm, Result& r) :
+        juce::ThreadPoolJob(f.getFileName()), file(f), pool(p), formatManager(fm), result(r) {}
+
+        JobStatus runJob() override
+        {
+            // The pool has as many threads as renderers, there's always one free.
+            auto* renderer = pool.take();
+            jassert(renderer != nullptr);
+
+            result = renderer->render(file, formatManager);
+            pool.giveBack(renderer);
+
+            return jobHasFinished;
+        }
+
+        juce::File file;
+        RenderPool& pool;
+        juce::AudioFormatManager& formatManager;
+        Result& result;
+    };
+
+    //==============================================================================
+
+    bool parseOptions(const juce::ArgumentList& args, Options& options)
+    {
+        for (const auto& arg : args.arguments)
+        {
+            auto text = arg.text;
+
+            if (!arg.isLongOption())
+            {
+                options.inputFiles.add(arg.resolveAsFile());
+                continue;
+            }
+
+            auto name = text.upToFirstOccurrenceOf("=", false, false);
+            auto value = text.fromFirstOccurrenceOf("=", false, false).unquoted();
+
+            if (name == "--preset")        options.presetFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+            else if (name == "--out")      options.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+            else if (name == "--format")   options.outputFormat = value.trimCharactersAtStart(".");
+            else if (name == "--threads")  options.numThreads = juce::jlimit(1, 256, value.getIntValue());
+            else if (name == "--block")    options.blockSize = juce::jlimit(1, 1 << 16, value.getIntValue());
+            else if (name == "--double")   options.doublePrecision = true;
+            else if (name == "--cpu")
+            {
+                CpuLevel level;
+
+                if (!parseCpuLevel(value, level) || level > getDetectedCpuLevel())
+                {
+                    std::cerr << "can't run " << value << " kernels here, this CPU does up to "
+                              << getCpuLevelName(getDetectedCpuLevel()) << std::endl;
+                    return false;
+                }
+
+                setCpuLevel(level);
+            }
+            else
+            {
+                std::cerr << "unknown option " << text << std::endl;
+                return false;
+            }
+        }
+
+        return options.presetFile != juce::File() && options.outputDirectory != juce::File()
+            && !options.inputFiles.isEmpty();
+    }
+
+    // The binary state as setStateInformation() takes it, converted if the preset is XML.
+    bool loadPreset(const juce::File& file, juce::MemoryBlock& preset)
+    {
+        if (!file.loadFileAsData(preset))
+            return false;
+
+        if (auto xml = juce::parseXML(preset.toString()))
+        {
+            auto tree = juce::ValueTree::fromXml(*xml);
+
+            if (!tree.isValid())
+                return false;
+
+            preset.reset();
+            juce::MemoryOutputStream mos(preset, false);
+            tree.writeToStream(mos);
+        }
+
+        return preset.getSize() > 0;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    // The processor expects a message manager (parameter listeners, async updates), it never has to run.
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    Options options;
+
+    if (!parseOptions(juce::ArgumentList(argc, argv), options))
+    {
+        std::cerr << "usage: EelEQRender --preset=<file> --out=<dir> [--format=wav|aiff|flac]"
+                     " [--threads=N] [--block=N] [--double] [--cpu=baseline|sse4.1|avx2|avx512] <files...>" << std::endl;
+        return 1;
+    }
+
+    // The writer starts by deleting its file, that would be the one we're about to read.
+    for (const auto& input : options.inputFiles)
+    {
+        if (getOutputFile(options, input) == input)
+        {
+            std::cerr << input.getFullPathName() << " would be overwritten by its own output,"
+                         " use another --out or --format" << std::endl;
+            return 1;
+        }
+    }
+
+    juce::MemoryBlock preset;
+
+    if (!loadPreset(options.presetFile, preset))
+    {
+        std::cerr << "can't load preset " << options.presetFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    if (!options.outputDirectory.createDirectory())
+    {
+        std::cerr << "can't create " << options.outputDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    juce::AudioFormatManager formatManager;
+    formatManager.registerBasicFormats();
+
+    options.numThreads = juce::jmin(options.numThreads, options.inputFiles.size());
+
+    RenderPool renderers(preset, options);
+    std::vector<Result> results((size_t)options.inputFiles.size());
+
+    auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    {
+        juce::ThreadPool pool(options.numThreads);
+
+        for (int i = 0; i < options.inputFiles.size(); ++i)
+            pool.addJob(new RenderJob(options.inputFiles[i], renderers, formatManager, results[(size_t)i]), true);
+
+        while (pool.getNumJobs() > 0)
+            juce::Thread::sleep(20);
+    }
+
+    auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) * 0.001;
+
+    double audioSeconds = 0.0, processSeconds = 0.0;
+    int numFailed = 0;
+
+    for (int i = 0; i < options.inputFiles.size(); ++i)
+    {
+        const auto& result = results[(size_t)i];
+
+        if (result.error.isNotEmpty())
+        {
+            std::cerr << result.error << std::endl;
+            ++numFailed;
+            continue;
+        }
+
+        audioSeconds += result.audioSeconds;
+        processSeconds += result.processSeconds;
+
+        std::cout << options.inputFiles[i].getFileName() << ": "
+                  << juce::String(result.audioSeconds, 1) << " s, "
+                  << juce::String(result.audioSeconds / juce::jmax(1.0e-9, result.processSeconds), 1) << "x realtime" << std::endl;
+    }
+
+    std::cout << options.inputFiles.size() - numFailed << " files, " << juce::String(audioSeconds, 1) << " s of audio in "
+              << juce::String(wallSeconds, 1) << " s on " << options.numThreads << " threads ("
+              << getCpuLevelName(getCpuLevel()) << " kernels)" << std::endl
+              << "per core: " << juce::String(audioSeconds / juce::jmax(1.0e-9, processSeconds), 1) << "x realtime, "
+              << "overall: " << juce::String(audioSeconds / juce::jmax(1.0e-9, wallSeconds), 1) << "x realtime" << std::endl;
+
+    return numFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,862 @@
+/*
+  ==============================================================================
+
+    Main.cpp
+    Created: 17 Oct 2026 11:46:25pm
+    Author:  Lusikka
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include <complex>
+#include <iostream>
+#include "../../../Source/PluginProcessor.h"
+
+//==============================================================================
+// Checks the optimised engines against the juce::dsp::IIR::Filter cascade (MonoChain).
+//
+//   EelEQVerify [--max-error=1e-4] [--max-magnitude=0.01] [--max-phase=0.1]
+//               [--max-denormals=0] [--quick] [--verbose]
+//
+// The candidates are SIMDChain in float and double on every CpuDispatch level the
+// CPU has (simd-float@avx2, ...), and the Left/Right and Mid/Side modes.
+//
+// Every case (sample rate, cut slopes, cut structure, band setup) drives the
+// reference and each candidate with the same stereo signals: an impulse, a log
+// sweep, noise in random block sizes, and noise under random automation (every
+// band's frequency, gain and Q redesigned every 256 samples, the bands stay on).
+//
+// Per candidate and case it reports the largest sample error, the largest magnitude
+// (dB) and phase (degrees) deviation of each band on its own (from impulse
+// responses, where the reference is above -60 dB), and NaN/Inf and denormal
+// outputs. Denormals are counted with flush-to-zero off, they're what a host
+// without it would run into.
+//
+// A double precision cascade runs alongside as the exact answer. A candidate over
+// a tolerance only fails if it's also further from the exact answer than the
+// reference is: the float reference loses it with poles near DC, a double section
+// there is allowed to disagree with it. NaN/Inf always fail. Exit code 1 on any failure.
+//
+// On top of that, low cuts with poles near DC (20 - 30 Hz at 96 and 192 kHz): with
+// "Cut Structure" on Parallel every candidate has to come out as close to the exact
+// answer as it does with the cascade, which gets double sections there. And every
+// CpuDispatch level has to give exactly the same samples as the baseline, in float
+// and double, so a render on one machine matches the plugin on another.
+
+namespace
+{
+    struct Tolerances
+    {
+        double maxError = 1.0e-4;
+        double maxMagnitudeDb = 0.01;
+        double maxPhaseDegrees = 0.1;
+        int maxDenormals = 0;
+    };
+
+    constexpr int maxBlockSize = 1024;
+    constexpr int automationInterval = 256;
+    constexpr int impulseOrder = 15;
+
+    //==============================================================================
+    // Stereo in, stereo out, double buffers for everyone so nothing is lost between them.
+
+    struct Engine
+    {
+        virtual ~Engine() = default;
+
+        virtual juce::String getName() const = 0;
+        virtual bool isFloat() const = 0;
+
+        virtual void prepare(double sampleRate) = 0;
+        virtual void setCoefficients(const ChainCoefficients& chainCoefficients) = 0;
+        virtual void process(juce::AudioBuffer<double>& buffer, int start, int numSamples) = 0;
+    };
+
+    // The reference: one MonoChain per channel, float, like the plugin used to run.
+    struct ReferenceEngine : Engine
+    {
+        juce::String getName() const override { return "reference"; }
+        bool isFloat() const override { return true; }
+
+        void prepare(double sampleRate) override
+        {
+            juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32)maxBlockSize, 1 };
+
+            for (auto& chain : chains)
+            {
+                prepareBiquads(chain);
+                chain.prepare(spec);
+                chain.reset();
+            }
+
+            scratch.setSize(1, maxBlockSize);
+        }
+
+        void setCoefficients(const ChainCoefficients& chainCoefficients) override
+        {
+            for (auto& chain : chains)
+                UpdateChainCoefficients(chain, chainCoefficients);
+        }
+
+        void process(juce::AudioBuffer<double>& buffer, int start, int numSamples) override
+        {
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                auto* data = buffer.getWritePointer(ch, start);
+                auto* temp = scratch.getWritePointer(0);
+
+                for (int i = 0; i < numSamples; ++i)
+                    temp[i] = (float)data[i];
+
+                juce::dsp::AudioBlock<float> block(scratch.getArrayOfWritePointers(), 1, (size_t)numSamples);
+                chains[(size_t)ch].process(juce::dsp::ProcessContextReplacing<float>(block));
+
+                for (int i = 0; i < numSamples; ++i)
+                    data[i] = (double)temp[i];
+            }
+        }
+
+    private:
+        std::array<MonoChain, 2> chains;
+        juce::AudioBuffer<float> scratch;
+    };
+
+    // The exact answer: the same cascade, same section slots, in double.
+    struct ExactEngine : Engine
+    {
+        juce::String getName() const override { return "exact"; }
+        bool isFloat() const override { return false; }
+
+        void prepare(double) override
+        {
+            for (auto& channel : state)
+                for (auto& section : channel)
+                    section = {};
+
+            active.fill(false);
+        }
+
+        void setCoefficients(const ChainCoefficients& chainCoefficients) override
+        {
+            const auto& settings = chainCoefficients.settings;
+
+            auto setCut = [this](int firstSlot, const CutCoefficients& cut, Slope slope, bool on)
+            {
+                for (int i = 0; i < MaxCutSections; ++i)
+                {
+                    active[(size_t)(firstSlot + i)] = on && i < getNumCutSections(slope);
+                    coefficients[(size_t)(firstSlot + i)] = cut.sections[(size_t)i];
+                }
+            };
+
+            setCut(0, chainCoefficients.lowCut, settings.lowCutSlope, isBandActive(settings, ChainPositions::LowCut));
+
+            active[peakSlot] = isBandActive(settings, ChainPositions::Peak);
+            coefficients[peakSlot] = chainCoefficients.peak;
+
+            setCut(peakSlot + 1, chainCoefficients.highCut, settings.highCutSlope, isBandActive(settings, ChainPositions::HighCut));
+        }
+
+        void process(juce::AudioBuffer<double>& buffer, int start, int numSamples) override
+        {
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                auto* data = buffer.getWritePointer(ch, start);
+
+                for (size_t slot = 0; slot < numSlots; ++slot)
+                {
+                    if (!active[slot])
+                        continue;
+
+                    const auto& c = coefficients[slot];
+                    auto& s = state[(size_t)ch][slot];
+
+                    for (int i = 0; i < numSamples; ++i)
+                    {
+                        auto x = data[i];
+                        auto y = c.b0 * x + s.s1;
+
+                        s.s1 = c.b1 * x - c.a1 * y + s.s2;
+                        s.s2 = c.b2 * x - c.a2 * y;
+                        data[i] = y;
+                    }
+                }
+            }
+        }
+
+    private:
+        static constexpr size_t peakSlot = MaxCutSections;
+        static constexpr size_t numSlots = 2 * MaxCutSections + 1;
+
+        struct State { double s1 = 0.0, s2 = 0.0; };
+
+        std::array<BiquadCoefficients, numSlots> coefficients;
+        std::array<bool, numSlots> active {};
+        std::array<std::array<State, numSlots>, 2> state;
+    };
+
+    // SIMDChain as the plugin runs it, on one CpuDispatch level's kernels. No band
+    // crossfades, the bands switch like the reference's.
+    template<typename SampleType>
+    struct SIMDEngine : Engine
+    {
+        SIMDEngine(ChannelMode mode, CpuLevel level) : channelMode(mode), cpuLevel(level) {}
+
+        juce::String getName() const override
+        {
+            juce::String name = std::is_same<SampleType, float>::value ? "simd-float" : "simd-double";
+
+            if (channelMode == ChannelMode::ChannelMode_LeftRight)  name << "-leftright";
+            if (channelMode == ChannelMode::ChannelMode_MidSide)    name << "-midside";
+
+            return name + "@" + getCpuLevelName(cpuLevel);
+        }
+
+        bool isFloat() const override { return std::is_same<SampleType, float>::value; }
+
+        void prepare(double sampleRate) override
+        {
+            // The chain takes its kernels in prepare().
+            setCpuLevel(cpuLevel);
+
+            chain.prepare({ sampleRate, (juce::uint32)maxBlockSize, 2 });
+            chain.setChannelMode(channelMode);
+            chain.setCrossfadeLength(0);
+
+            scratch.setSize(2, maxBlockSize);
+        }
+
+        void setCoefficients(const ChainCoefficients& chainCoefficients) override
+        {
+            if (channelMode == ChannelMode::ChannelMode_Stereo)
+            {
+                chain.setChainCoefficients(chainCoefficients);
+                return;
+            }
+
+            // Both channel sets on the same settings, it has to come out as in Stereo mode.
+            chain.setChannelSetCoefficients(chainCoefficients, 0);
+            chain.setChannelSetCoefficients(chainCoefficients, 1);
+        }
+
+        void process(juce::AudioBuffer<double>& buffer, int start, int numSamples) override
+        {
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < numSamples; ++i)
+                    scratch.setSample(ch, i, (SampleType)buffer.getSample(ch, start + i));
+
+            juce::dsp::AudioBlock<SampleType> block(scratch.getArrayOfWritePointers(), 2, (size_t)numSamples);
+            chain.process(juce::dsp::ProcessContextReplacing<SampleType>(block));
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < numSamples; ++i)
+                    buffer.setSample(ch, start + i, (double)scratch.getSample(ch, i));
+        }
+
+    private:
+        SIMDChain<SampleType> chain;
+        ChannelMode channelMode;
+        CpuLevel cpuLevel;
+        juce::AudioBuffer<SampleType> scratch;
+    };
+
+    //==============================================================================
+
+    struct Case
+    {
+        double sampleRate;
+        Slope slope;
+        CutStructure cutStructure;
+        juce::String setupName;
+        ChainSettings settings;
+
+        juce::String getName() const
+        {
+            return juce::String(juce::roundToInt(sampleRate)) + " " + juce::String(12 + 12 * (int)slope) + " dB/Oct "
+                 + (cutStructure == CutStructure_Parallel ? "parallel " : "cascade ") + setupName;
+        }
+    };
+
+    struct Report
+    {
+        double errorToReference = 0.0, errorToExact = 0.0;
+        std::array<double, NumChainPositions> magnitudeDb {}, phaseDegrees {};
+        std::array<double, NumChainPositions> magnitudeDbToExact {}, phaseDegreesToExact {};
+        int numNaNs = 0, numDenormals = 0;
+    };
+
+    std::vector<Case> makeCases(bool quick)
+    {
+        std::vector<double> sampleRates { 44100.0, 48000.0, 96000.0, 192000.0 };
+        std::vector<Slope> slopes { Slope_12, Slope_24, Slope_36, Slope_48 };
+
+        if (quick)
+        {
+            sampleRates = { 48000.0, 192000.0 };
+            slopes = { Slope_12, Slope_48 };
+        }
+
+        // A typical curve, and one on the edges: a low cut with poles near DC at the
+        // higher rates, a narrow bell and a high cut close to Nyquist.
+        ChainSettings typical;
+        typical.lowCutFreq = 80.f;
+        typical.highCutFreq = 12000.f;
+        typical.peakFreq = 1000.f;
+        typical.peakGainInDecibels = 6.f;
+        typical.peakQuality = 1.f;
+
+        ChainSettings edges;
+        edges.lowCutFreq = 25.f;
+        edges.highCutFreq = 19000.f;
+        edges.peakFreq = 16000.f;
+        edges.peakGainInDecibels = -12.f;
+        edges.peakQuality = 8.f;
+
+        std::vector<Case> cases;
+
+        for (auto sampleRate : sampleRates)
+        {
+            for (auto slope : slopes)
+            {
+                for (auto cutStructure : { CutStructure_Cascade, CutStructure_Parallel })
+                {
+                    for (auto setup : { std::make_pair("typical", typical), std::make_pair("edges", edges) })
+                    {
+                        auto settings = setup.second;
+                        settings.lowCutSlope = settings.highCutSlope = slope;
+                        settings.cutStructure = cutStructure;
+
+                        cases.push_back({ sampleRate, slope, cutStructure, setup.first, settings });
+                    }
+                }
+            }
+        }
+
+        return cases;
+    }
+
+    //==============================================================================
+
+    struct Verifier
+    {
+        explicit Verifier(const Tolerances& t) : tolerances(t)
+        {
+            // Every instruction set this CPU has, the split modes only on the best one.
+            auto best = getDetectedCpuLevel();
+
+            for (int level = 0; level <= best; ++level)
+            {
+                candidates.push_back(std::make_unique<SIMDEngine<float>>(ChannelMode::ChannelMode_Stereo, (CpuLevel)level));
+                candidates.push_back(std::make_unique<SIMDEngine<double>>(ChannelMode::ChannelMode_Stereo, (CpuLevel)level));
+            }
+
+            candidates.push_back(std::make_unique<SIMDEngine<float>>(ChannelMode::ChannelMode_LeftRight, best));
+            candidates.push_back(std::make_unique<SIMDEngine<float>>(ChannelMode::ChannelMode_MidSide, best));
+        }
+
+        // Returns the number of failures.
+        int run(const Case& c, bool verbose)
+        {
+            int numFailures = 0;
+
+            for (auto& candidate : candidates)
+            {
+                auto report = verify(c, *candidate);
+                auto failures = getFailures(report);
+
+                if (verbose || failures.isNotEmpty())
+                    print(c, *candidate, report, failures);
+
+                if (failures.isNotEmpty())
+                    ++numFailures;
+
+                auto& worst = worstReports[candidate->getName()];
+                worst.errorToReference = juce::jmax(worst.errorToReference, report.errorToReference);
+                worst.numNaNs += report.numNaNs;
+                worst.numDenormals += report.numDenormals;
+
+                for (size_t band = 0; band < NumChainPositions; ++band)
+                {
+                    worst.magnitudeDb[band] = juce::jmax(worst.magnitudeDb[band], report.magnitudeDb[band]);
+                    worst.phaseDegrees[band] = juce::jmax(worst.phaseDegrees[band], report.phaseDegrees[band]);
+                }
+            }
+
+            return numFailures;
+        }
+
+        // Returns the number of failures.
+        int runParallelNearDC(bool quick, bool verbose)
+        {
+            std::vector<double> sampleRates { 96000.0, 192000.0 };
+            std::vector<float> frequencies { 20.f, 25.f, 30.f };
+
+            if (quick)
+            {
+                sampleRates = { 192000.0 };
+                frequencies = { 25.f };
+            }
+
+            int numFailures = 0;
+
+            for (auto sampleRate : sampleRates)
+            {
+                for (auto frequency : frequencies)
+                {
+                    for (auto slope : { Slope_24, Slope_48 })
+                    {
+                        ChainSettings settings;
+                        settings.lowCutFreq = frequency;
+                        settings.lowCutSlope = slope;
+                        settings.peakBypassed = settings.highCutBypassed = true;
+
+                        auto name = juce::String(juce::roundToInt(sampleRate)) + " " + juce::String(12 + 12 * (int)slope)
+                                  + " dB/Oct low cut at " + juce::String(frequency) + " Hz, parallel vs cascade";
+
+                        for (auto& candidate : candidates)
+                        {
+                            settings.cutStructure = CutStructure_Cascade;
+                            auto cascade = getErrorToExact(*candidate, settings, sampleRate);
+
+                            settings.cutStructure = CutStructure_Parallel;
+                            auto parallel = getErrorToExact(*candidate, settings, sampleRate);
+
+                            // A little slack, they don't have to be the same samples.
+                            auto failed = !std::isfinite(parallel) || parallel > 2.0 * cascade + 1.0e-9;
+
+                            if (verbose || failed)
+                                std::cout << name << " | " << candidate->getName()
+                                          << " | exact error parallel " << juce::String(parallel, 9)
+                                          << ", cascade " << juce::String(cascade, 9)
+                                          << " | " << (failed ? "FAIL" : "ok") << std::endl;
+
+                            if (failed)
+                                ++numFailures;
+                        }
+                    }
+                }
+            }
+
+            return numFailures;
+        }
+
+        // Returns the number of failures.
+        int runLevelsMatch(const Case& c, bool verbose)
+        {
+            return checkLevelsMatch<float>(c, verbose) + checkLevelsMatch<double>(c, verbose);
+        }
+
+        void printSummary() const
+        {
+            std::cout << std::endl << "worst over all cases:" << std::endl;
+
+            for (const auto& entry : worstReports)
+            {
+                const auto& report = entry.second;
+
+                std::cout << "  " << entry.first << ": error " << juce::String(report.errorToReference, 9)
+                          << ", magnitude " << juce::String(juce::jmax(report.magnitudeDb[0], report.magnitudeDb[1], report.magnitudeDb[2]), 4) << " dB"
+                          << ", phase " << juce::String(juce::jmax(report.phaseDegrees[0], report.phaseDegrees[1], report.phaseDegrees[2]), 3) << " deg"
+                          << ", NaN/Inf " << report.numNaNs << ", denormals " << report.numDenormals << std::endl;
+            }
+        }
+
+    private:
+        const Tolerances& tolerances;
+        std::vector<std::unique_ptr<Engine>> candidates;
+        std::map<juce::String, Report> worstReports;
+
+        ReferenceEngine reference;
+        ExactEngine exact;
+
+        juce::String getFailures(const Report& report) const
+        {
+            juce::StringArray failures;
+
+            if (report.numNaNs > 0)
+                failures.add("NaN/Inf");
+
+            if (report.numDenormals > tolerances.maxDenormals)
+                failures.add("denormals");
+
+            // Over a tolerance and no closer to the exact answer than the reference.
+            if (report.errorToReference > tolerances.maxError && report.errorToExact > referenceReport.errorToExact)
+                failures.add("error");
+
+            for (size_t band = 0; band < NumChainPositions; ++band)
+            {
+                if (report.magnitudeDb[band] > tolerances.maxMagnitudeDb
+                    && report.magnitudeDbToExact[band] > referenceReport.magnitudeDbToExact[band])
+                    failures.add("magnitude " + getBandName(band));
+
+                if (report.phaseDegrees[band] > tolerances.maxPhaseDegrees
+                    && report.phaseDegreesToExact[band] > referenceReport.phaseDegreesToExact[band])
+                    failures.add("phase " + getBandName(band));
+            }
+
+            return failures.joinIntoString(", ");
+        }
+
+        static juce::String getBandName(size_t band)
+        {
+            return band == ChainPositions::LowCut ? "LowCut" : band == ChainPositions::Peak ? "Peak" : "HighCut";
+        }
+
+        void print(const Case& c, const Engine& candidate, const Report& report, const juce::String& failures) const
+        {
+            std::cout << c.getName() << " | " << candidate.getName()
+                      << " | error " << juce::String(report.errorToReference, 9)
+                      << " (exact " << juce::String(report.errorToExact, 9)
+                      << ", reference " << juce::String(referenceReport.errorToExact, 9) << ")";
+
+            for (size_t band = 0; band < NumChainPositions; ++band)
+                std::cout << " | " << getBandName(band) << " " << juce::String(report.magnitudeDb[band], 4) << " dB "
+                          << juce::String(report.phaseDegrees[band], 3) << " deg";
+
+            std::cout << " | NaN/Inf " << report.numNaNs << " denormals " << report.numDenormals
+                      << " | " << (failures.isEmpty() ? juce::String("ok") : "FAIL: " + failures) << std::endl;
+        }
+
+        //==============================================================================
+
+        Report referenceReport; // the reference against the exact answer, for the current case
+
+        Report verify(const Case& c, Engine& candidate)
+        {
+            Report report;
+            referenceReport = {};
+
+            std::vector<Engine*> engines { &reference, &candidate, &exact };
+
+            // Every signal from a clean start.
+            auto runSignal = [&](juce::AudioBuffer<double> input, bool automate, bool randomBlocks)
+            {
+                std::array<juce::AudioBuffer<double>, 3> outputs { input, input, input };
+                juce::Random random(42);
+                auto settings = c.settings;
+
+                for (size_t e = 0; e < engines.size(); ++e)
+                {
+                    engines[e]->prepare(c.sampleRate);
+                    engines[e]->setCoefficients(makeChainCoefficients(settings, c.sampleRate));
+                }
+
+                auto numSamples = input.getNumSamples();
+
+                for (int start = 0; start < numSamples;)
+                {
+                    auto length = randomBlocks ? 1 + random.nextInt(maxBlockSize) : automationInterval;
+                    length = juce::jmin(length, numSamples - start);
+
+                    if (automate && start > 0)
+                    {
+                        automateSettings(settings, c.settings, random);
+                        auto coefficients = makeChainCoefficients(settings, c.sampleRate);
+
+                        for (auto* engine : engines)
+                            engine->setCoefficients(coefficients);
+                    }
+
+                    for (size_t e = 0; e < engines.size(); ++e)
+                        engines[e]->process(outputs[e], start, length);
+
+                    start += length;
+                }
+
+                compare(outputs[1], outputs[0], outputs[2], candidate.isFloat(), report);
+
+                Report unused;
+                compare(outputs[0], outputs[0], outputs[2], true, unused);
+                referenceReport.errorToExact = juce::jmax(referenceReport.errorToExact, unused.errorToExact);
+            };
+
+            auto length = juce::roundToInt(c.sampleRate);
+
+            runSignal(makeImpulse(1 << impulseOrder), false, false);
+            runSignal(makeSweep(length, c.sampleRate), false, false);
+            runSignal(makeNoise(length, 1), false, true);
+            runSignal(makeNoise(length, 2), true, false);
+
+            // Each band on its own, from impulse responses.
+            for (size_t band = 0; band < NumChainPositions; ++band)
+                compareBand(c, candidate, (ChainPositions)band, report);
+
+            return report;
+        }
+
+        // A second of noise through one engine from a clean start, in maxBlockSize blocks.
+        static juce::AudioBuffer<double> renderNoise(Engine& engine, const ChainSettings& settings, double sampleRate, int seed)
+        {
+            auto output = makeNoise(juce::roundToInt(sampleRate), seed);
+
+            engine.prepare(sampleRate);
+            engine.setCoefficients(makeChainCoefficients(settings, sampleRate));
+
+            for (int start = 0; start < output.getNumSamples(); start += maxBlockSize)
+                engine.process(output, start, juce::jmin(maxBlockSize, output.getNumSamples() - start));
+
+            return output;
+        }
+
+        // Largest sample error against the exact answer, for a second of noise.
+        double getErrorToExact(Engine& candidate, const ChainSettings& settings, double sampleRate)
+        {
+            auto output = renderNoise(candidate, settings, sampleRate, 3);
+            auto exactOutput = renderNoise(exact, settings, sampleRate, 3);
+
+            Report report;
+            compare(output, exactOutput, exactOutput, candidate.isFloat(), report);
+
+            return report.numNaNs > 0 ? std::numeric_limits<double>::infinity() : report.errorToExact;
+        }
+
+        // Every level against the baseline, sample for sample.
+        template<typename SampleType>
+        static int checkLevelsMatch(const Case& c, bool verbose)
+        {
+            SIMDEngine<SampleType> baseline(ChannelMode::ChannelMode_Stereo, CpuLevel_Baseline);
+            auto expected = renderNoise(baseline, c.settings, c.sampleRate, 4);
+            int numFailures = 0;
+
+            for (int level = CpuLevel_Baseline + 1; level <= getDetectedCpuLevel(); ++level)
+            {
+                SIMDEngine<SampleType> candidate(ChannelMode::ChannelMode_Stereo, (CpuLevel)level);
+                auto output = renderNoise(candidate, c.settings, c.sampleRate, 4);
+                int numDifferent = 0;
+
+                for (int ch = 0; ch < 2; ++ch)
+                    for (int i = 0; i < output.getNumSamples(); ++i)
+                        numDifferent += output.getSample(ch, i) != expected.getSample(ch, i) ? 1 : 0;
+
+                if (verbose || numDifferent > 0)
+                    std::cout << c.getName() << " | " << candidate.getName() << " vs " << baseline.getName()
+                              << " | " << numDifferent << " samples differ | " << (numDifferent > 0 ? "FAIL" : "ok") << std::endl;
+
+                if (numDifferent > 0)
+                    ++numFailures;
+            }
+
+            return numFailures;
+        }
+
+        // Frequency, gain and Q move around the case's values, the bands stay on.
+        static void automateSettings(ChainSettings& settings, const ChainSettings& centre, juce::Random& random)
+        {
+            auto around = [&random](float value, float octaves, float minimum, float maximum)
+            {
+                return juce::jlimit(minimum, maximum, value * std::pow(2.f, (random.nextFloat() * 2.f - 1.f) * octaves));
+            };
+
+            settings.lowCutFreq = around(centre.lowCutFreq, 1.f, MinCutFrequency + 1.f, 2000.f);
+            settings.highCutFreq = around(centre.highCutFreq, 1.f, 1000.f, MaxCutFrequency - 1.f);
+            settings.peakFreq = around(centre.peakFreq, 1.f, 20.f, 20000.f);
+            settings.peakQuality = around(centre.peakQuality, 1.f, 0.1f, 15.f);
+
+            auto gain = centre.peakGainInDecibels + (random.nextFloat() * 2.f - 1.f) * 6.f;
+            settings.peakGainInDecibels = gain == 0.f ? 0.1f : gain;
+        }
+
+        // Sample errors, NaN/Inf and denormals. 'output' against both the reference and the exact answer.
+        static void compare(const juce::AudioBuffer<double>& output, const juce::AudioBuffer<double>& referenceOutput,
+                            const juce::AudioBuffer<double>& exactOutput, bool isFloat, Report& report)
+        {
+            auto smallest = isFloat ? (double)std::numeric_limits<float>::min() : std::numeric_limits<double>::min();
+
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                for (int i = 0; i < output.getNumSamples(); ++i)
+                {
+                    auto y = output.getSample(ch, i);
+
+                    if (!std::isfinite(y))
+                    {
+                        ++report.numNaNs;
+                        continue;
+                    }
+
+                    if (y != 0.0 && std::abs(y) < smallest)
+                        ++report.numDenormals;
+
+                    report.errorToReference = juce::jmax(report.errorToReference, std::abs(y - referenceOutput.getSample(ch, i)));
+                    report.errorToExact = juce::jmax(report.errorToExact, std::abs(y - exactOutput.getSample(ch, i)));
+                }
+            }
+        }
+
+        void compareBand(const Case& c, Engine& candidate, ChainPositions band, Report& report)
+        {
+            auto settings = c.settings;
+            settings.lowCutBypassed = band != ChainPositions::LowCut;
+            settings.peakBypassed = band != ChainPositions::Peak;
+            settings.highCutBypassed = band != ChainPositions::HighCut;
+
+            auto coefficients = makeChainCoefficients(settings, c.sampleRate);
+            std::array<Engine*, 3> engines { &reference, &candidate, &exact };
+            std::array<std::vector<std::complex<double>>, 3> spectra;
+
+            for (size_t e = 0; e < engines.size(); ++e)
+            {
+                auto impulse = makeImpulse(1 << impulseOrder);
+
+                engines[e]->prepare(c.sampleRate);
+                engines[e]->setCoefficients(coefficients);
+
+                for (int start = 0; start < impulse.getNumSamples(); start += maxBlockSize)
+                    engines[e]->process(impulse, start, juce::jmin(maxBlockSize, impulse.getNumSamples() - start));
+
+                spectra[e] = getSpectrum(impulse);
+            }
+
+            auto binWidth = c.sampleRate / (1 << impulseOrder);
+            auto lastFrequency = juce::jmin(20000.0, 0.45 * c.sampleRate);
+
+            for (size_t bin = 1; bin < spectra[0].size(); ++bin)
+            {
+                auto frequency = (double)bin * binWidth;
+
+                if (frequency < 20.0 || frequency > lastFrequency || std::abs(spectra[0][bin]) < 0.001) // -60 dB
+                    continue;
+
+                auto deviation = [](std::complex<double> a, std::complex<double> b)
+                {
+                    auto ratio = a / b;
+                    return std::make_pair(std::abs(juce::Decibels::gainToDecibels(std::abs(ratio), -300.0)),
+                                          std::abs(juce::radiansToDegrees(std::arg(ratio))));
+                };
+
+                auto toReference = deviation(spectra[1][bin], spectra[0][bin]);
+                auto toExact = deviation(spectra[1][bin], spectra[2][bin]);
+                auto referenceToExact = deviation(spectra[0][bin], spectra[2][bin]);
+
+                report.magnitudeDb[band] = juce::jmax(report.magnitudeDb[band], toReference.first);
+                report.phaseDegrees[band] = juce::jmax(report.phaseDegrees[band], toReference.second);
+                report.magnitudeDbToExact[band] = juce::jmax(report.magnitudeDbToExact[band], toExact.first);
+                report.phaseDegreesToExact[band] = juce::jmax(report.phaseDegreesToExact[band], toExact.second);
+                referenceReport.magnitudeDbToExact[band] = juce::jmax(referenceReport.magnitudeDbToExact[band], referenceToExact.first);
+                referenceReport.phaseDegreesToExact[band] = juce::jmax(referenceReport.phaseDegreesToExact[band], referenceToExact.second);
+            }
+        }
+
+        // Left channel's impulse response, one complex bin per frequency up to Nyquist.
+        static std::vector<std::complex<double>> getSpectrum(const juce::AudioBuffer<double>& impulseResponse)
+        {
+            juce::dsp::FFT fft(impulseOrder);
+            std::vector<float> data((size_t)(2 << impulseOrder), 0.f);
+
+            for (int i = 0; i < (1 << impulseOrder); ++i)
+                data[(size_t)i] = (float)impulseResponse.getSample(0, i);
+
+            fft.performRealOnlyForwardTransform(data.data(), true);
+
+            std::vector<std::complex<double>> spectrum((size_t)(1 << (impulseOrder - 1)) + 1);
+
+            for (size_t bin = 0; bin < spectrum.size(); ++bin)
+                spectrum[bin] = { (double)data[2 * bin], (double)data[2 * bin + 1] };
+
+            return spectrum;
+        }
+
+        //==============================================================================
+        // Left and right always differ, Mid/Side has something to split.
+
+        static juce::AudioBuffer<double> makeImpulse(int length)
+        {
+            juce::AudioBuffer<double> buffer(2, length);
+            buffer.clear();
+            buffer.setSample(0, 0, 1.0);
+            buffer.setSample(1, 7, -0.5);
+            return buffer;
+        }
+
+        static juce::AudioBuffer<double> makeSweep(int length, double sampleRate)
+        {
+            juce::AudioBuffer<double> buffer(2, length);
+
+            auto f0 = 20.0, f1 = 0.45 * sampleRate;
+            auto k = std::log(f1 / f0);
+            auto duration = length / sampleRate;
+
+            for (int i = 0; i < length; ++i)
+            {
+                auto t = i / sampleRate;
+                auto phase = juce::MathConstants<double>::twoPi * f0 * duration / k * (std::exp(t / duration * k) - 1.0);
+
+                buffer.setSample(0, i, 0.5 * std::sin(phase));
+                buffer.setSample(1, i, 0.25 * std::cos(phase));
+            }
+
+            return buffer;
+        }
+
+        static juce::AudioBuffer<double> makeNoise(int length, int seed)
+        {
+            juce::AudioBuffer<double> buffer(2, length);
+            juce::Random random(seed);
+
+            for (int ch = 0; ch < 2; ++ch)
+                for (int i = 0; i < length; ++i)
+                    buffer.setSample(ch, i, random.nextDouble() - 0.5);
+
+            return buffer;
+        }
+    };
+
+    bool parseOptions(const juce::ArgumentList& args, Tolerances& tolerances, bool& quick, bool& verbose)
+    {
+        for (const auto& arg : args.arguments)
+        {
+            auto text = arg.text;
+            auto name = text.upToFirstOccurrenceOf("=", false, false);
+            auto value = text.fromFirstOccurrenceOf("=", false, false);
+
+            if (name == "--max-error")           tolerances.maxError = value.getDoubleValue();
+            else if (name == "--max-magnitude")  tolerances.maxMagnitudeDb = value.getDoubleValue();
+            else if (name == "--max-phase")      tolerances.maxPhaseDegrees = value.getDoubleValue();
+            else if (name == "--max-denormals")  tolerances.maxDenormals = value.getIntValue();
+            else if (name == "--quick")          quick = true;
+            else if (name == "--verbose")        verbose = true;
+            else
+            {
+                std::cerr << "unknown option " << text << std::endl;
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    Tolerances tolerances;
+    bool quick = false, verbose = false;
+
+    if (!parseOptions(juce::ArgumentList(argc, argv), tolerances, quick, verbose))
+    {
+        std::cerr << "usage: EelEQVerify [--max-error=1e-4] [--max-magnitude=0.01] [--max-phase=0.1]"
+                     " [--max-denormals=0] [--quick] [--verbose]" << std::endl;
+        return 1;
+    }
+
+    Verifier verifier(tolerances);
+    auto cases = makeCases(quick);
+    int numFailures = 0;
+
+    for (const auto& c : cases)
+    {
+        numFailures += verifier.run(c, verbose);
+        numFailures += verifier.runLevelsMatch(c, verbose);
+    }
+
+    numFailures += verifier.runParallelNearDC(quick, verbose);
+
+    verifier.printSummary();
+
+    std::cout << cases.size() << " cases, " << numFailures << " failures" << std::endl;
+
+    return numFailures == 0 ? 0 : 1;
+}